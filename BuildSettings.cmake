@@ -3,4 +3,8 @@ if (APPLE)
     set(GAMEWINDOW_SYSTEM_DEFAULT GLFW)
 endif()
 
-set(GAMEWINDOW_SYSTEM ${GAMEWINDOW_SYSTEM_DEFAULT} CACHE STRING "The implementation to use for windows - EGLUT or GLFW")
\ No newline at end of file
+set(GAMEWINDOW_SYSTEM ${GAMEWINDOW_SYSTEM_DEFAULT} CACHE STRING "The implementation to use for windows - EGLUT, GLFW, SDL3 or HEADLESS (EGL pbuffers without a window system)")
+
+option(GAMEWINDOW_METRICS "Collect the counters and histograms of GameWindowManager::getMetricsSnapshot" OFF)
+option(GAMEWINDOW_BUILD_BENCH "Build gamewindow_bench, requires Google Benchmark" OFF)
+set(GAMEWINDOW_BENCH_MAPPINGS "" CACHE FILEPATH "gamecontrollerdb.txt read by the mapping benchmarks of gamewindow_bench_json")
@@ -0,0 +1,319 @@
+// Hot paths of the input and windowing layer, run with --benchmark_format=json or build gamewindow_bench_json
+// The window benchmarks run against the backend selected by GAMEWINDOW_SYSTEM, only HEADLESS works without a display
+// Mapping benchmarks read GAMEWINDOW_BENCH_MAPPINGS, by default gamecontrollerdb.txt in the working directory
+
+#include <benchmark/benchmark.h>
+#include <game_window_manager.h>
+#include <key_mapping.h>
+#include "gamepad_mapping_parser.h"
+#include "gamepad_mapping_database.h"
+#include "joystick_manager.h"
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+#include <unistd.h>
+
+static std::shared_ptr<GameWindow> const& getBenchWindow() {
+    static std::shared_ptr<GameWindow> window = [] {
+        auto window = GameWindowManager::getManager()->createWindow("gamewindow_bench", 640, 480, GraphicsApi::OPENGL_ES2);
+        window->setSwapInterval(0);
+        return window;
+    }();
+    return window;
+}
+
+static std::string getMappingsPath() {
+    const char* path = getenv("GAMEWINDOW_BENCH_MAPPINGS");
+    return path != nullptr ? path : "gamecontrollerdb.txt";
+}
+
+static bool readMappings(std::string& content) {
+    std::ifstream file(getMappingsPath(), std::ios::binary);
+    if (!file)
+        return false;
+    std::stringstream ss;
+    ss << file.rdbuf();
+    content = ss.str();
+    return true;
+}
+
+// Mix of the events a game sees in a busy frame
+static void fillSyntheticEvents(EventBuffer& buffer, size_t count) {
+    buffer.clear();
+    for (size_t i = 0; i < count; i++) {
+        switch (i % 6) {
+        case 0:
+            buffer.push(GameWindowEventType::MOUSE_POSITION, i).mousePosition = {(double)i, (double)i};
+            break;
+        case 1:
+            buffer.push(GameWindowEventType::MOUSE_RELATIVE_POSITION, i).mousePosition = {1.0, -1.0};
+            break;
+        case 2:
+            buffer.push(GameWindowEventType::KEYBOARD, i).keyboard = {KeyCode::W, (i / 6) % 2 ? KeyAction::RELEASE : KeyAction::PRESS, 0};
+            break;
+        case 3:
+            buffer.push(GameWindowEventType::MOUSE_BUTTON, i).mouseButton = {0.0, 0.0, 1, (i / 6) % 2 ? MouseButtonAction::RELEASE : MouseButtonAction::PRESS};
+            break;
+        case 4:
+            buffer.push(GameWindowEventType::GAMEPAD_AXIS, i).gamepadAxis = {0, GamepadAxisId::LEFT_X, (float)(i % 100) / 100.0f};
+            break;
+        default:
+            buffer.pushText(GameWindowEventType::KEYBOARD_TEXT, i, "w");
+            break;
+        }
+    }
+}
+
+// Sets an environment variable for the lifetime of the object, the previous value is restored afterwards
+class ScopedEnv {
+private:
+    std::string name, previous;
+    bool hadPrevious;
+
+public:
+    ScopedEnv(const char* name, const char* value) : name(name) {
+        const char* old = getenv(name);
+        hadPrevious = old != nullptr;
+        if (hadPrevious)
+            previous = old;
+        setenv(name, value, 1);
+    }
+
+    ~ScopedEnv() {
+        if (hadPrevious)
+            setenv(name.c_str(), previous.c_str(), 1);
+        else
+            unsetenv(name.c_str());
+    }
+};
+
+// The window outlives the benchmarks, resetCallbacks has to drop the reference to calls before it goes out of scope
+static void setCountingCallbacks(GameWindow& window, size_t& calls) {
+    window.setMousePositionCallback([&calls](double, double) { calls++; });
+    window.setMouseRelativePositionCallback([&calls](double, double) { calls++; });
+    window.setKeyboardCallback([&calls](KeyCode, KeyAction, int) { calls++; });
+    window.setMouseButtonCallback([&calls](double, double, int, MouseButtonAction) { calls++; });
+    window.setGamepadAxisCallback([&calls](int, GamepadAxisId, float) { calls++; });
+    window.setTextInputCallback([&calls](std::string_view) { calls++; });
+}
+
+static void resetCallbacks(GameWindow& window) {
+    window.setMousePositionCallback(nullptr);
+    window.setMouseRelativePositionCallback(nullptr);
+    window.setKeyboardCallback(nullptr);
+    window.setMouseButtonCallback(nullptr);
+    window.setGamepadAxisCallback(nullptr);
+    window.setTextInputCallback(nullptr);
+}
+
+class CountingSink : public GameWindowEventSink {
+public:
+    size_t calls = 0;
+
+    void onMousePosition(double x, double y) override { calls++; }
+    void onMouseRelativePosition(double x, double y) override { calls++; }
+    void onKeyboard(KeyCode key, KeyAction action, int mods) override { calls++; }
+    void onMouseButton(double x, double y, int button, MouseButtonAction action) override { calls++; }
+    void onGamepadAxis(int id, GamepadAxisId axis, float val) override { calls++; }
+    void onTextInput(std::string_view text) override { calls++; }
+};
+
+static void BM_DispatchCallbacks(benchmark::State& state) {
+    auto& window = getBenchWindow();
+    size_t calls = 0;
+    setCountingCallbacks(*window, calls);
+    EventBuffer buffer;
+    fillSyntheticEvents(buffer, state.range(0));
+    for (auto _ : state) {
+        window->dispatchEvents(buffer);
+        benchmark::DoNotOptimize(calls);
+    }
+    resetCallbacks(*window);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DispatchCallbacks)->Arg(64)->Arg(1024);
+
+static void BM_DispatchSink(benchmark::State& state) {
+    auto& window = getBenchWindow();
+    auto sink = std::make_shared<CountingSink>();
+    window->setEventSink(sink);
+    EventBuffer buffer;
+    fillSyntheticEvents(buffer, state.range(0));
+    for (auto _ : state) {
+        window->dispatchEvents(buffer);
+        benchmark::DoNotOptimize(sink->calls);
+    }
+    window->setEventSink(nullptr);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DispatchSink)->Arg(64)->Arg(1024);
+
+// Injected events take the same path as native ones, including coalescing and the axis filter
+static void BM_PollInjectedEvents(benchmark::State& state) {
+    auto& window = getBenchWindow();
+    size_t calls = 0;
+    setCountingCallbacks(*window, calls);
+    EventBuffer buffer;
+    fillSyntheticEvents(buffer, state.range(0));
+    for (auto _ : state) {
+        for (auto& ev : buffer)
+            window->injectEvent(ev, buffer.getText(ev));
+        window->pollEvents();
+        benchmark::DoNotOptimize(calls);
+    }
+    resetCallbacks(*window);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PollInjectedEvents)->Arg(64)->Arg(1024);
+
+static void BM_PollSwap(benchmark::State& state) {
+    auto& window = getBenchWindow();
+    window->makeCurrent(true);
+    for (auto _ : state) {
+        window->pollEvents();
+        window->swapBuffers();
+    }
+}
+BENCHMARK(BM_PollSwap);
+
+static void BM_GetKeyFromKeyCode(benchmark::State& state) {
+    auto& window = getBenchWindow();
+    for (auto _ : state) {
+        for (int i = 0; i < KEY_CODE_COUNT; i++)
+            benchmark::DoNotOptimize(window->getKeyFromKeyCode((KeyCode)i, 0));
+    }
+    state.SetItemsProcessed(state.iterations() * KEY_CODE_COUNT);
+}
+BENCHMARK(BM_GetKeyFromKeyCode);
+
+// getKeyMinecraft of the backends is private, this has the shape of their tables: identity for the low codes plus a sparse high range
+static constexpr NativeKeyMapping benchKeyMappings[] = {
+    mapKeys(0xffbe, KeyCode::FN1, 12),
+    mapKey(0xff08, KeyCode::BACKSPACE),
+    mapKey(0xff09, KeyCode::TAB),
+    mapKey(0xff0d, KeyCode::ENTER),
+    mapKey(0xffe1, KeyCode::LEFT_SHIFT),
+    mapKey(0xffe2, KeyCode::RIGHT_SHIFT),
+    mapKey(0xff51, KeyCode::LEFT),
+    mapKey(0xff52, KeyCode::UP),
+    mapKey(0xff53, KeyCode::RIGHT),
+    mapKey(0xff54, KeyCode::DOWN),
+};
+static constexpr NativeKeyTable<0, 0xff> benchLowKeys(benchKeyMappings, true);
+static constexpr NativeKeyTable<0xfe00, 0xffff> benchHighKeys(benchKeyMappings);
+
+static void BM_NativeKeyTable(benchmark::State& state) {
+    int natives[] = {'a', 'W', ' ', 0xff08, 0xff0d, 0xffe1, 0xff51, 0xffbe, 0x1234, 0xffff};
+    for (auto _ : state) {
+        // Keeps the compiler from folding the lookups
+        benchmark::DoNotOptimize(natives);
+        for (int native : natives)
+            benchmark::DoNotOptimize(native < 0x100 ? benchLowKeys[native] : benchHighKeys[native]);
+    }
+    state.SetItemsProcessed(state.iterations() * (sizeof(natives) / sizeof(natives[0])));
+}
+BENCHMARK(BM_NativeKeyTable);
+
+static void BM_ParseMappings(benchmark::State& state) {
+    std::string content;
+    if (!readMappings(content)) {
+        state.SkipWithError(("Can't read " + getMappingsPath()).c_str());
+        return;
+    }
+    size_t lines = 0;
+    for (auto _ : state) {
+        forEachGamepadMapping(content, [&](std::string_view line) { lines++; });
+        benchmark::DoNotOptimize(lines);
+    }
+    state.SetBytesProcessed(state.iterations() * content.size());
+}
+BENCHMARK(BM_ParseMappings);
+
+// Builds the index on every iteration, the cache is disabled
+static void BM_MappingDatabaseBuild(benchmark::State& state) {
+    std::string path = getMappingsPath();
+    ScopedEnv cache("GAMEWINDOW_GAMEPAD_MAPPINGS_CACHE", "");
+    for (auto _ : state) {
+        GamepadMappingDatabase database;
+        if (!database.addFile(path)) {
+            state.SkipWithError(("Can't read " + path).c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(database.find("030000005e0400008e02000014010000"));
+    }
+}
+BENCHMARK(BM_MappingDatabaseBuild)->Unit(benchmark::kMillisecond);
+
+// Maps the index cached by the first iteration
+static void BM_MappingDatabaseCached(benchmark::State& state) {
+    std::string path = getMappingsPath();
+    char cacheDir[] = "/tmp/gamewindow_bench_XXXXXX";
+    if (mkdtemp(cacheDir) == nullptr) {
+        state.SkipWithError("Can't create the cache directory");
+        return;
+    }
+    {
+        ScopedEnv cache("GAMEWINDOW_GAMEPAD_MAPPINGS_CACHE", cacheDir);
+        for (auto _ : state) {
+            GamepadMappingDatabase database;
+            if (!database.addFile(path)) {
+                state.SkipWithError(("Can't read " + path).c_str());
+                break;
+            }
+            benchmark::DoNotOptimize(database.find("030000005e0400008e02000014010000"));
+        }
+    }
+    if (DIR* dir = opendir(cacheDir)) {
+        while (dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] != '.')
+                remove((std::string(cacheDir) + "/" + entry->d_name).c_str());
+        }
+        closedir(dir);
+    }
+    rmdir(cacheDir);
+}
+BENCHMARK(BM_MappingDatabaseCached)->Unit(benchmark::kMicrosecond);
+
+// What addGamePadMapping costs on top of the backend, a fresh database per iteration so the overrides don't pile up
+static void BM_MappingDatabaseOverride(benchmark::State& state) {
+    std::string content;
+    if (!readMappings(content)) {
+        state.SkipWithError(("Can't read " + getMappingsPath()).c_str());
+        return;
+    }
+    for (auto _ : state) {
+        GamepadMappingDatabase database;
+        database.addOverride(content);
+        benchmark::DoNotOptimize(database.find("030000005e0400008e02000014010000"));
+    }
+    state.SetBytesProcessed(state.iterations() * content.size());
+}
+BENCHMARK(BM_MappingDatabaseOverride)->Unit(benchmark::kMillisecond);
+
+// Only builds the suggested mapping in builds without NDEBUG
+// Swallows the reports of debug builds, the default handler prints every one of them to stderr
+class SilentErrorHandler : public GameWindowErrorHandler {
+public:
+    bool onError(std::string title, std::string errormsg) override {
+        return false;
+    }
+};
+
+static void BM_HandleMissingGamePadMapping(benchmark::State& state) {
+    auto manager = GameWindowManager::getManager();
+    auto previousHandler = manager->getErrorHandler();
+    manager->setErrorHandler(std::make_shared<SilentErrorHandler>());
+    for (auto _ : state) {
+        bool ret = JoystickManager::handleMissingGamePadMapping("Bench Gamepad", "03000000de2800000112000001000000", 6, 17, 1, [](std::string mapping) {
+            benchmark::DoNotOptimize(mapping.data());
+            return true;
+        });
+        benchmark::DoNotOptimize(ret);
+    }
+    manager->setErrorHandler(previousHandler);
+}
+BENCHMARK(BM_HandleMissingGamePadMapping);
+
+BENCHMARK_MAIN();
@@ -1,92 +1,293 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <functional>
 #include <vector>
-#include "key_mapping.h"
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <bitset>
+#include <cstdio>
+#include <mutex>
+#include <atomic>
+#include "game_window_event.h"
+#include "game_window_event_sink.h"
+#include "game_window_shared_context.h"
 
 enum class GraphicsApi {
     OPENGL,
     OPENGL_ES2
 };
-enum class KeyAction {
-    PRESS,
-    REPEAT,
-    RELEASE
-};
-enum class MouseButtonAction {
-    PRESS,
-    RELEASE
-};
-enum class GamepadButtonId {
-    A,
-    B,
-    X,
-    Y,
-    LB,
-    RB,
-    BACK,
-    START,
-    GUIDE,
-    LEFT_STICK,
-    RIGHT_STICK,
-    DPAD_UP,
-    DPAD_RIGHT,
-    DPAD_DOWN,
-    DPAD_LEFT,
-    UNKNOWN = -1
-};
-enum class GamepadAxisId {
-    LEFT_X,
-    LEFT_Y,
-    RIGHT_X,
-    RIGHT_Y,
-    LEFT_TRIGGER,
-    RIGHT_TRIGGER,
-    UNKNOWN = -1
-};
 struct FullscreenMode {
     int id = 0;
+    // Filled for the modes of getFullscreenModes, see getDescription
     std::string description;
+    // 0 if unknown
+    int width = 0, height = 0;
+    double refreshRate = 0.0;
+    double pixelDensity = 1.0;
+    // Mode list the id belongs to, modes of other lists are matched by their properties or description instead
+    uint32_t generation = 0;
+
+    // e.g. "1920x1080 @ 60", built on each call
+    std::string getDescription() const {
+        char desc[64];
+        if(pixelDensity != 1.0)
+            snprintf(desc, sizeof(desc), "%dx%d @ %g * %g", width, height, refreshRate, pixelDensity);
+        else
+            snprintf(desc, sizeof(desc), "%dx%d @ %g", width, height, refreshRate);
+        return desc;
+    }
 };
 
+class GameWindowInputTraceRecorder;
+class GameWindowInputTracePlayer;
+class GameWindowFrameCapture;
+
 class GameWindow {
 public:
+    // Gamepad ids reported by all implementations are below this
+    static constexpr int MAX_GAMEPADS = 16;
+    // Further contacts are ignored until a slot is free again
+    static constexpr int MAX_TOUCH_POINTS = 16;
+
     using DrawCallback = std::function<void()>;
     using WindowSizeCallback = std::function<void(int, int)>;
+    using SurfaceChangedCallback = std::function<void(WindowSurface const&)>;
     using MouseButtonCallback = std::function<void(double, double, int, MouseButtonAction)>;
     using MousePositionCallback = std::function<void(double, double)>;
     using MouseScrollCallback = std::function<void(double, double, double, double)>;
     using TouchStartCallback = std::function<void(int, double, double)>;
     using TouchUpdateCallback = std::function<void(int, double, double)>;
     using TouchEndCallback = std::function<void(int, double, double)>;
+    using TouchFrameCallback = std::function<void(TouchPoint const*, size_t)>;
     using KeyboardCallback = std::function<void(KeyCode, KeyAction, int)>;
     using KeyboardTextCallback = std::function<void(std::string const&)>;
+    // The text is only valid during the call
+    using TextInputCallback = std::function<void(std::string_view)>;
     using DropCallback = std::function<void(std::string const&)>;
     using PasteCallback = std::function<void(std::string const&)>;
     using GamepadStateCallback = std::function<void(int, bool)>;
     using GamepadButtonCallback = std::function<void(int, GamepadButtonId, bool)>;
     using GamepadAxisCallback = std::function<void(int, GamepadAxisId, float)>;
+    using FocusCallback = std::function<void(bool)>;
+    using VisibilityCallback = std::function<void(bool)>;
     using CloseCallback = std::function<void()>;
 
+    struct MouseRelativeSample {
+        double x, y;
+    };
+
+    // All timestamps are monotonic nanoseconds, see getTimestamp
+    struct FrameLatency {
+        uint64_t presentTimestamp = 0;
+        // Oldest and newest input event dispatched since the previous present, 0 if there was none
+        uint64_t firstInputTimestamp = 0;
+        uint64_t lastInputTimestamp = 0;
+
+        uint64_t getInputToPresentLatency() const { return firstInputTimestamp != 0 ? presentTimestamp - firstInputTimestamp : 0; }
+    };
+
+    struct GamepadAxisFilter {
+        // Sticks closer than this to the center report 0, the remaining range is rescaled to start at 0
+        // Both deadzones are clamped to [0, 1) by setGamepadAxisFilter
+        float radialDeadzone = 0.0f;
+        // Same per axis, also applies to the triggers
+        float axialDeadzone = 0.0f;
+        // Smaller changes of the filtered value are dropped, resting and fully deflected positions are always reported
+        float changeThreshold = 0.0f;
+    };
+
+    struct PresentTiming {
+        // Monotonic nanoseconds the last vblank happened, see getTimestamp
+        uint64_t vblankTimestamp = 0;
+        // Vblank counter of the display and number of completed swaps of the window
+        uint64_t vblankCount = 0;
+        uint64_t swapCount = 0;
+    };
+
+    struct FramePacing {
+        // Frames per second to cap to, 0 uses refreshDivisor instead
+        double targetFrameRate = 0.0;
+        // Caps to the display refresh rate divided by this, 0 disables pacing
+        int refreshDivisor = 0;
+        // Waits at the start of pollEvents instead of after swapBuffers, so the input of a capped frame is as fresh as possible
+        bool lateInputSampling = false;
+        // Nanoseconds before the deadline the pacer stops sleeping and spins, the sleep granularity of the os
+        uint64_t spinThreshold = 1000000;
+    };
+
+    // Wait times in nanoseconds, only acquisitions which didn't get the lock immediately count as contended
+    struct LockWaitStats {
+        uint64_t acquisitions = 0;
+        uint64_t contendedAcquisitions = 0;
+        uint64_t totalWaitTime = 0;
+        uint64_t maxWaitTime = 0;
+    };
+
 private:
+    friend class GameWindowInputThread;
+
     DrawCallback drawCallback;
     WindowSizeCallback windowSizeCallback;
+    SurfaceChangedCallback surfaceChangedCallback;
     MouseButtonCallback mouseButtonCallback;
     MousePositionCallback mousePositionCallback, mouseRelativePositionCallback;
     MouseScrollCallback mouseScrollCallback;
     TouchStartCallback touchStartCallback;
     TouchUpdateCallback touchUpdateCallback;
     TouchEndCallback touchEndCallback;
+    TouchFrameCallback touchFrameCallback;
     KeyboardCallback keyboardCallback;
-    KeyboardTextCallback keyboardTextCallback;
+    TextInputCallback textInputCallback;
     DropCallback dropCallback;
     PasteCallback pasteCallback;
     GamepadStateCallback gamepadStateCallback;
     GamepadButtonCallback gamepadButtonCallback;
     GamepadAxisCallback gamepadAxisCallback;
+    FocusCallback focusCallback;
+    VisibilityCallback visibilityCallback;
     CloseCallback closeCallback;
 
+    // Set while pollEvents(EventBuffer&) runs, events are recorded instead of dispatched
+    EventBuffer* eventBuffer = nullptr;
+    // Set by GameWindowInputThread on the pumping thread, the events are delivered later on the consuming thread
+    EventBuffer* captureBuffer = nullptr;
+    std::shared_ptr<GameWindowEventSink> eventSink;
+
+    // Set on the consuming thread, read by the thread pumping the events
+    std::atomic<bool> coalesceMouseRelative{false};
+    std::atomic<bool> keepMouseRelativeHistory{false};
+    // The pending event and its samples are only touched by the thread pumping the events
+    bool hasPendingMouseRelative = false;
+    // Motion samples merged into the pending event
+    uint32_t pendingMouseRelativeCount = 0;
+    double pendingMouseRelativeX = 0.0, pendingMouseRelativeY = 0.0;
+    uint64_t pendingMouseRelativeTimestamp = 0;
+    std::vector<MouseRelativeSample> pendingMouseRelativeHistory;
+    // Samples of the events pumped by GameWindowInputThread which the consuming thread didn't take yet
+    std::mutex capturedMouseRelativeHistoryLock;
+    std::vector<MouseRelativeSample> capturedMouseRelativeHistory;
+    // Only touched by the consuming thread
+    std::vector<MouseRelativeSample> mouseRelativeHistory;
+
+    void takeCapturedMouseRelativeHistory();
+
+    // Native timestamp of the event being dispatched, 0 if the backend doesn't provide one
+    uint64_t nativeEventTimestamp = 0;
+    uint64_t lastEventTimestamp = 0;
+    uint64_t lastPresentTimestamp = 0;
+    uint64_t firstFrameInputTimestamp = 0, lastFrameInputTimestamp = 0;
+    FrameLatency lastFrameLatency;
+
+    FramePacing framePacing;
+    // Refresh divisor used while the user didn't configure pacing, set if the driver ignores the swap interval
+    int swapIntervalEmulation = 0;
+    uint64_t nextFrameDeadline = 0;
+    // Applies while unfocused or invisible, 0 disables the throttle
+    double backgroundFrameRate = 0.0;
+    bool windowFocused = true, windowVisible = true;
+    uint64_t queuedEventCount = 0;
+    // Taken by beginPollEvents for the metrics
+    uint64_t pollStartTimestamp = 0, pollStartEventCount = 0;
+
+    // Set on the consuming thread, copied to activeGamepadAxisFilter by the thread pumping the events once changed
+    GamepadAxisFilter gamepadAxisFilter;
+    std::mutex gamepadAxisFilterLock;
+    std::atomic<bool> gamepadAxisFilterChanged{false};
+    GamepadAxisFilter activeGamepadAxisFilter;
+    struct GamepadAxisState {
+        int id;
+        float raw[6];
+        float reported[6];
+    };
+    // Only touched by the thread pumping the events
+    std::vector<GamepadAxisState> gamepadAxisStates;
+
+    void filterGamepadAxis(int id, GamepadAxisId axis, float val);
+
+    // Updated on the thread the events are delivered on
+    GamepadState gamepadStates[MAX_GAMEPADS];
+    uint32_t changedGamepads = 0;
+
+    void updateGamepadState(GameWindowEvent const& ev);
+
+    // Native contact id per touch slot, only touched by the thread pumping the events
+    int64_t touchSlotIds[MAX_TOUCH_POINTS];
+    // Bit (1 << slot) per used touch slot
+    uint32_t touchSlots = 0;
+    bool touchFrameChanged = false;
+    // Updated on the thread the events are delivered on
+    std::vector<TouchPoint> touchFrame;
+    bool touchFrameDelivered = false;
+
+    int getTouchSlot(int64_t nativeId, bool assign);
+    void updateTouchFrame(GameWindowEvent const& ev);
+
+    // Set by the implementations while pumping, compared to the reported one at the end of the poll
+    WindowSurface pendingSurface = {}, reportedSurface = {};
+    // Updated on the thread the events are delivered on
+    WindowSurface surface = {};
+
+    // Filled by injectEvent on any thread, replayed by endPollEvents
+    std::mutex injectedEventsLock;
+    EventBuffer injectedEvents, dispatchedInjectedEvents;
+    std::atomic<bool> hasInjectedEvents{false};
+
+    void dispatchInjectedEvents();
+
+    // Only used by the thread pumping the events
+    std::shared_ptr<GameWindowInputTraceRecorder> traceRecorder;
+    std::shared_ptr<GameWindowInputTracePlayer> tracePlayer;
+
+    void recordTraceEvent(GameWindowEvent const& ev, std::string_view text);
+    void endTracePoll();
+    void replayTrace();
+
+    // Only used by the thread presenting the frames
+    std::shared_ptr<GameWindowFrameCapture> frameCapture;
+    // Pixel size of the drawable as width << 32 | height, set on the thread pumping the events and read by captureFrame
+    std::atomic<uint64_t> drawableSize{0};
+
+    void captureFrame();
+
+    // Set by the paste shortcut, the clipboard is read once the native events were dispatched
+    bool pasteRequested = false;
+    size_t pasteSizeLimit = 0, pasteChunkSize = 0;
+
+    // Updated on the thread the events are delivered on, cleared when the window loses focus
+    std::bitset<KEY_CODE_COUNT> keyState;
+    std::bitset<32> mouseButtonState;
+
+    void paceFrame();
+
+    // Startup timings of GameWindowManager
+    bool contextMadeCurrent = false;
+
+    void recordFirstContextCurrent();
+    void recordFirstSwap();
+
+    GameWindowEvent makeEvent(GameWindowEventType type) {
+        GameWindowEvent ev;
+        ev.type = type;
+        ev.timestamp = nativeEventTimestamp != 0 ? nativeEventTimestamp : getTimestamp();
+        return ev;
+    }
+
+    void queueEvent(GameWindowEvent const& ev, std::string_view text = {}) {
+        queuedEventCount++;
+        if(traceRecorder != nullptr)
+            recordTraceEvent(ev, text);
+        if(captureBuffer != nullptr)
+            captureBuffer->push(ev, text);
+        else
+            deliverEvent(ev, text);
+    }
+
+    // Records the event into the event buffer or invokes the sink or callback
+    void deliverEvent(GameWindowEvent const& ev, std::string_view text);
+
 public:
     GameWindow(std::string const& title, int width, int height, GraphicsApi api) {}
 
@@ -102,6 +303,30 @@ public:
 
     virtual void pollEvents() = 0;
 
+    // Like pollEvents, but blocks up to timeout seconds until an event arrives
+    virtual void waitEvents(double timeout) {
+        pollEvents();
+    }
+
+    // Polls events into a reusable buffer instead of invoking the callbacks
+    void pollEvents(EventBuffer& buffer) {
+        buffer.clear();
+        eventBuffer = &buffer;
+        pollEvents();
+        eventBuffer = nullptr;
+    }
+
+    // Invokes the callbacks for all events of the buffer
+    void dispatchEvents(EventBuffer const& buffer) {
+        for(auto& ev : buffer)
+            deliverEvent(ev, buffer.getText(ev));
+    }
+
+    // Handles the event like one received by the implementation during the next poll, may be called from any thread
+    // Text events take the text from text, a timestamp of 0 is replaced by the time of dispatch
+    // TOUCH_FRAME is ignored, touch frames are derived from the touch events
+    void injectEvent(GameWindowEvent const& ev, std::string_view text = {});
+
     virtual void setCursorDisabled(bool disabled) = 0;
 
     virtual bool getCursorDisabled() = 0;
@@ -117,6 +342,7 @@ public:
 
     virtual void swapBuffers() = 0;
 
+    // -1 requests adaptive vsync, tearing only frames which missed the vblank, falls back to 1 if unsupported
     virtual void setSwapInterval(int interval) = 0;
 
     virtual void startTextInput() {}
@@ -129,18 +355,41 @@ public:
         return {-1};
     }
 
-    virtual std::vector<FullscreenMode> getFullscreenModes() {
-        return {};
+    // Modes of the monitor the window is on, the reference remains valid until the next pollEvents
+    virtual std::vector<FullscreenMode> const& getFullscreenModes() {
+        static const std::vector<FullscreenMode> noModes;
+        return noModes;
     }
 
     virtual uint32_t getKeyFromKeyCode(KeyCode code, int metaState) {
         return 0;
     }
 
+    // Context for uploading resources on a worker thread, nullptr if the implementation doesn't support it
+    virtual std::shared_ptr<GameWindowSharedContext> createSharedContext() {
+        return nullptr;
+    }
+
+    // Contention of the lock taken by pollEvents and the other window state changes
+    virtual LockWaitStats getEventLockWaitStats() {
+        return {};
+    }
+
+    // Contention of the lock taken by swapBuffers, makeCurrent and setSwapInterval
+    virtual LockWaitStats getPresentLockWaitStats() {
+        return {};
+    }
+
     void setDrawCallback(DrawCallback callback) { drawCallback = std::move(callback); }
 
     void setWindowSizeCallback(WindowSizeCallback callback) { windowSizeCallback = std::move(callback); }
 
+    // Called at most once per poll, only if the pixel size, window size or content scale actually changed
+    void setSurfaceChangedCallback(SurfaceChangedCallback callback) { surfaceChangedCallback = std::move(callback); }
+
+    // As of the delivered events, zero until the first poll
+    WindowSurface const& getSurface() const { return surface; }
+
     void setMouseButtonCallback(MouseButtonCallback callback) { mouseButtonCallback = std::move(callback); }
 
     void setMousePositionCallback(MousePositionCallback callback) { mousePositionCallback = std::move(callback); }
@@ -153,9 +402,22 @@ public:
 
     void setTouchEndCallback(TouchEndCallback callback) { touchEndCallback = std::move(callback); }
 
+    // Called once per poll in which the touches changed, the start, update and end callbacks are still called for each change
+    void setTouchFrameCallback(TouchFrameCallback callback) { touchFrameCallback = std::move(callback); }
+
     void setKeyboardCallback(KeyboardCallback callback) { keyboardCallback = std::move(callback); }
 
-    void setKeyboardTextCallback(KeyboardTextCallback callback) { keyboardTextCallback = std::move(callback); }
+    // Copies the text of every event, prefer setTextInputCallback
+    void setKeyboardTextCallback(KeyboardTextCallback callback) {
+        if(callback == nullptr) {
+            textInputCallback = nullptr;
+            return;
+        }
+        textInputCallback = [callback = std::move(callback)](std::string_view text) { callback(std::string(text)); };
+    }
+
+    // Replaces the keyboard text callback
+    void setTextInputCallback(TextInputCallback callback) { textInputCallback = std::move(callback); }
 
     void setDropCallback(DropCallback callback) { dropCallback = std::move(callback); }
 
@@ -164,82 +426,376 @@ public:
     // Used when the cursor is disabled
     void setMouseRelativePositionCallback(MousePositionCallback callback) { mouseRelativePositionCallback = std::move(callback); }
 
+    // Sums up all relative mouse motion of one pollEvents call into a single event
+    // keepHistory additionally records the individual samples, see getMouseRelativeHistory
+    void setMouseRelativeCoalescing(bool coalesce, bool keepHistory = false) {
+        coalesceMouseRelative = coalesce;
+        keepMouseRelativeHistory = coalesce && keepHistory;
+        mouseRelativeHistory.clear();
+    }
+
+    // Samples summed up during the last pollEvents call, with GameWindowInputThread the samples of the events it dispatched last,
+    // which may already include samples of an event dispatched by its next call
+    std::vector<MouseRelativeSample> const& getMouseRelativeHistory() const { return mouseRelativeHistory; }
+
+    static uint64_t getTimestamp() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Timestamp of the event currently or last dispatched, also valid inside the callbacks
+    uint64_t getLastEventTimestamp() const { return lastEventTimestamp; }
+
+    // Time swapBuffers returned the last time
+    uint64_t getLastPresentTimestamp() const { return lastPresentTimestamp; }
+
+    FrameLatency const& getLastFrameLatency() const { return lastFrameLatency; }
+
+    // Caps the frame rate independent of vsync, pass a default constructed FramePacing to disable it
+    void setFramePacing(FramePacing const& pacing) {
+        framePacing = pacing;
+        nextFrameDeadline = 0;
+    }
+
+    FramePacing const& getFramePacing() const { return framePacing; }
+
+    // Applies to all implementations, by default only unchanged values are dropped
+    void setGamepadAxisFilter(GamepadAxisFilter const& filter);
+
+    GamepadAxisFilter const& getGamepadAxisFilter() const { return gamepadAxisFilter; }
+
+    // Current state of a gamepad as of the delivered events, false if the id is unknown or disconnected
+    bool getGamepadState(int id, GamepadState& state) const {
+        if(id < 0 || id >= MAX_GAMEPADS || !gamepadStates[id].connected)
+            return false;
+        state = gamepadStates[id];
+        return true;
+    }
+
+    // Bit (1 << id) per gamepad which changed since the last swapBuffers
+    uint32_t getChangedGamepads() const { return changedGamepads; }
+
+    // Contacts of the last delivered touch frame, ordered by the time they started
+    std::vector<TouchPoint> const& getTouchFrame() const { return touchFrame; }
+
+    // Pastes are truncated to maxSize bytes and delivered as several paste events of up to chunkSize bytes, 0 disables either
+    // Both are kept at UTF-8 character boundaries
+    void setPasteLimits(size_t maxSize, size_t chunkSize) {
+        pasteSizeLimit = maxSize;
+        pasteChunkSize = chunkSize;
+    }
+
+    // Whether a key is held as of the delivered events, all keys are released when the window loses focus
+    bool isKeyDown(KeyCode key) const {
+        return (int)key > 0 && (int)key < KEY_CODE_COUNT && keyState.test((int)key);
+    }
+
+    // Indexed by KeyCode
+    std::bitset<KEY_CODE_COUNT> const& getKeyboardState() const { return keyState; }
+
+    // Uses the button ids of the mouse button callback
+    bool isMouseButtonDown(int button) const {
+        return button >= 0 && button < (int)mouseButtonState.size() && mouseButtonState.test(button);
+    }
+
+    std::bitset<32> const& getMouseButtonState() const { return mouseButtonState; }
+
+    // Caps the frame rate while the window is unfocused, minimized or occluded, 0 disables the throttle
+    void setBackgroundFrameRate(double frameRate) { backgroundFrameRate = frameRate; }
+
+    double getBackgroundFrameRate() const { return backgroundFrameRate; }
+
+    // Refresh rate of the display showing the window in Hz, 0 if unknown
+    virtual double getDisplayRefreshRate() {
+        return 0.0;
+    }
+
+    // Swap interval in effect, -1 if adaptive vsync was requested and is supported
+    virtual int getSwapInterval() {
+        return 0;
+    }
+
+    // Timestamps of the most recent completed present, false if the implementation can't report them
+    virtual bool getPresentTiming(PresentTiming& timing) {
+        return false;
+    }
+
     void setGamepadStateCallback(GamepadStateCallback callback) { gamepadStateCallback = std::move(callback); }
 
     void setGamepadButtonCallback(GamepadButtonCallback callback) { gamepadButtonCallback = std::move(callback); }
 
     void setGamepadAxisCallback(GamepadAxisCallback callback) { gamepadAxisCallback = std::move(callback); }
 
+    void setFocusCallback(FocusCallback callback) { focusCallback = std::move(callback); }
+
+    void setVisibilityCallback(VisibilityCallback callback) { visibilityCallback = std::move(callback); }
+
     void setCloseCallback(CloseCallback callback) { closeCallback = std::move(callback); }
 
+    // Writes every dispatched event to the trace, one chunk per poll, nullptr stops recording
+    // Set it on the thread pumping the events, between polls
+    void setInputTraceRecorder(std::shared_ptr<GameWindowInputTraceRecorder> recorder);
+
+    // Replays the trace at the end of each poll in addition to the native events, nullptr stops the replay
+    // The events are dispatched as recorded, without being coalesced or filtered again
+    void setInputTracePlayer(std::shared_ptr<GameWindowInputTracePlayer> player) { tracePlayer = std::move(player); }
+
+    // Hands the capture every frame presented by swapBuffers, nullptr stops capturing
+    // Set it on the thread presenting the frames, with the context current
+    void setFrameCapture(std::shared_ptr<GameWindowFrameCapture> capture) { frameCapture = std::move(capture); }
+
+    // Routes all events to the sink instead of the callbacks, nullptr restores the callbacks
+    void setEventSink(std::shared_ptr<GameWindowEventSink> sink) { eventSink = std::move(sink); }
+
+    const std::shared_ptr<GameWindowEventSink>& getEventSink() { return eventSink; }
+
 protected:
+    // Called by the implementations around pumping the native events
+    void beginPollEvents();
+    void endPollEvents();
+
+    // Applies to the events dispatched after this call, pass 0 to use the time of dispatch again
+    void setEventTimestamp(uint64_t timestamp) {
+        nativeEventTimestamp = timestamp;
+    }
+    // Called by the implementations whenever they made the context of the window current
+    void onContextCurrent() {
+        if(!contextMadeCurrent) {
+            contextMadeCurrent = true;
+            recordFirstContextCurrent();
+        }
+    }
+    // Called by the implementations before presenting a frame
+    void beginSwapBuffers() {
+        if(frameCapture != nullptr)
+            captureFrame();
+    }
+    // Called by the implementations after presenting a frame
+    void endSwapBuffers() {
+        if(lastPresentTimestamp == 0)
+            recordFirstSwap();
+        lastPresentTimestamp = getTimestamp();
+        lastFrameLatency.presentTimestamp = lastPresentTimestamp;
+        lastFrameLatency.firstInputTimestamp = firstFrameInputTimestamp;
+        lastFrameLatency.lastInputTimestamp = lastFrameInputTimestamp;
+        firstFrameInputTimestamp = lastFrameInputTimestamp = 0;
+        changedGamepads = 0;
+        if(!framePacing.lateInputSampling)
+            paceFrame();
+    }
+
+    bool isBackgroundThrottled() const {
+        return backgroundFrameRate > 0.0 && (!windowFocused || !windowVisible);
+    }
+
+    // Increases with every event produced by the implementation
+    uint64_t getQueuedEventCount() const { return queuedEventCount; }
+
+    // Whether the next endPollEvents dispatches injected events
+    bool hasPendingInjectedEvents() const { return hasInjectedEvents.load(std::memory_order_acquire); }
+
+    // For drivers ignoring the swap interval, paces to the refresh rate divided by interval unless the user configured pacing
+    void setSwapIntervalEmulation(int interval) {
+        swapIntervalEmulation = interval;
+        nextFrameDeadline = 0;
+    }
+
     void onDraw() {
+        // The consuming thread draws on its own while the events are pumped by GameWindowInputThread
+        if(captureBuffer != nullptr)
+            return;
+        if(eventSink != nullptr) {
+            eventSink->onDraw();
+            return;
+        }
         if(drawCallback != nullptr)
             drawCallback();
     }
-    void onWindowSizeChanged(int w, int h) {
-        if(windowSizeCallback != nullptr)
-            windowSizeCallback(w, h);
+    // May be called any number of times per poll, the change is reported once by endPollEvents
+    void setSurface(int pixelWidth, int pixelHeight, int width, int height, float scaleX, float scaleY) {
+        pendingSurface = {pixelWidth, pixelHeight, width, height, scaleX, scaleY};
+        setDrawableSize(pixelWidth, pixelHeight);
+    }
+    // For implementations learning the size before the surface is reported, frames are captured at this size
+    void setDrawableSize(int pixelWidth, int pixelHeight) {
+        drawableSize.store((uint64_t)(uint32_t)pixelWidth << 32 | (uint32_t)pixelHeight, std::memory_order_relaxed);
     }
     void onMouseButton(double x, double y, int button, MouseButtonAction action) {
-        if(mouseButtonCallback != nullptr)
-            mouseButtonCallback(x, y, button, action);
+        auto ev = makeEvent(GameWindowEventType::MOUSE_BUTTON);
+        ev.mouseButton = {x, y, button, action};
+        queueEvent(ev);
     }
     void onMousePosition(double x, double y) {
-        if(mousePositionCallback != nullptr)
-            mousePositionCallback(x, y);
+        auto ev = makeEvent(GameWindowEventType::MOUSE_POSITION);
+        ev.mousePosition = {x, y};
+        queueEvent(ev);
     }
     void onMouseRelativePosition(double x, double y) {
-        if(mouseRelativePositionCallback != nullptr)
-            mouseRelativePositionCallback(x, y);
+        auto ev = makeEvent(GameWindowEventType::MOUSE_RELATIVE_POSITION);
+        if(coalesceMouseRelative) {
+            pendingMouseRelativeX += x;
+            pendingMouseRelativeY += y;
+            pendingMouseRelativeTimestamp = ev.timestamp;
+            hasPendingMouseRelative = true;
+            pendingMouseRelativeCount++;
+            if(keepMouseRelativeHistory)
+                pendingMouseRelativeHistory.push_back({x, y});
+            return;
+        }
+        ev.mousePosition = {x, y};
+        queueEvent(ev);
     }
     void onMouseScroll(double x, double y, double dx, double dy) {
-        if(mouseScrollCallback != nullptr)
-            mouseScrollCallback(x, y, dx, dy);
+        auto ev = makeEvent(GameWindowEventType::MOUSE_SCROLL);
+        ev.mouseScroll = {x, y, dx, dy};
+        queueEvent(ev);
+    }
+    void onTouchStart(int id, double x, double y, float pressure = 1.0f) {
+        auto ev = makeEvent(GameWindowEventType::TOUCH_START);
+        ev.touch = {id, x, y, pressure};
+        touchFrameChanged = true;
+        queueEvent(ev);
+    }
+    void onTouchUpdate(int id, double x, double y, float pressure = 1.0f) {
+        auto ev = makeEvent(GameWindowEventType::TOUCH_UPDATE);
+        ev.touch = {id, x, y, pressure};
+        touchFrameChanged = true;
+        queueEvent(ev);
     }
-    void onTouchStart(int id, double x, double y) {
-        if(touchStartCallback != nullptr)
-            touchStartCallback(id, x, y);
+    void onTouchEnd(int id, double x, double y, float pressure = 0.0f) {
+        auto ev = makeEvent(GameWindowEventType::TOUCH_END);
+        ev.touch = {id, x, y, pressure};
+        touchFrameChanged = true;
+        queueEvent(ev);
     }
-    void onTouchUpdate(int id, double x, double y) {
-        if(touchUpdateCallback != nullptr)
-            touchUpdateCallback(id, x, y);
+    // Same as above but assign a touch slot to the native contact id, contacts are dropped while all slots are in use
+    void onNativeTouchStart(int64_t nativeId, double x, double y, float pressure = 1.0f) {
+        int slot = getTouchSlot(nativeId, true);
+        if(slot != -1)
+            onTouchStart(slot, x, y, pressure);
     }
-    void onTouchEnd(int id, double x, double y) {
-        if(touchEndCallback != nullptr)
-            touchEndCallback(id, x, y);
+    void onNativeTouchUpdate(int64_t nativeId, double x, double y, float pressure = 1.0f) {
+        int slot = getTouchSlot(nativeId, true);
+        if(slot != -1)
+            onTouchUpdate(slot, x, y, pressure);
+    }
+    void onNativeTouchEnd(int64_t nativeId, double x, double y, float pressure = 0.0f) {
+        int slot = getTouchSlot(nativeId, false);
+        if(slot == -1)
+            return;
+        touchSlots &= ~(1u << slot);
+        onTouchEnd(slot, x, y, pressure);
     }
     void onKeyboard(KeyCode key, KeyAction action, int mods) {
-        if(keyboardCallback != nullptr)
-            keyboardCallback(key, action, mods);
+        auto ev = makeEvent(GameWindowEventType::KEYBOARD);
+        ev.keyboard = {key, action, mods};
+        queueEvent(ev);
+    }
+    void onKeyboardText(std::string_view c) {
+        queueEvent(makeEvent(GameWindowEventType::KEYBOARD_TEXT), c);
     }
-    void onKeyboardText(std::string const& c) {
-        if(keyboardTextCallback != nullptr)
-            keyboardTextCallback(c);
+    void onKeyboardText(char32_t codepoint) {
+        char buf[4];
+        size_t length = encodeUtf8(codepoint, buf);
+        if(length > 0)
+            onKeyboardText(std::string_view(buf, length));
+    }
+
+    // Returns the number of bytes written to out, 0 for invalid codepoints
+    static size_t encodeUtf8(char32_t codepoint, char out[4]) {
+        if(codepoint < 0x80) {
+            out[0] = (char)codepoint;
+            return 1;
+        }
+        if(codepoint < 0x800) {
+            out[0] = (char)(0xC0 | (codepoint >> 6));
+            out[1] = (char)(0x80 | (codepoint & 0x3F));
+            return 2;
+        }
+        if(codepoint < 0x10000) {
+            if(codepoint >= 0xD800 && codepoint <= 0xDFFF)
+                return 0;
+            out[0] = (char)(0xE0 | (codepoint >> 12));
+            out[1] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+            out[2] = (char)(0x80 | (codepoint & 0x3F));
+            return 3;
+        }
+        if(codepoint < 0x110000) {
+            out[0] = (char)(0xF0 | (codepoint >> 18));
+            out[1] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+            out[2] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+            out[3] = (char)(0x80 | (codepoint & 0x3F));
+            return 4;
+        }
+        return 0;
     }
     void onDrop(std::string const& path) {
-        if(dropCallback != nullptr) {
-            dropCallback(path);
+        queueEvent(makeEvent(GameWindowEventType::DROP), path);
+    }
+    void onPaste(std::string_view c) {
+        if(pasteSizeLimit > 0 && c.size() > pasteSizeLimit)
+            c = c.substr(0, getUtf8Boundary(c, pasteSizeLimit));
+        while(pasteChunkSize > 0 && c.size() > pasteChunkSize) {
+            size_t length = getUtf8Boundary(c, pasteChunkSize);
+            if(length == 0)
+                length = pasteChunkSize;
+            queueEvent(makeEvent(GameWindowEventType::PASTE), c.substr(0, length));
+            c.remove_prefix(length);
         }
+        queueEvent(makeEvent(GameWindowEventType::PASTE), c);
     }
-    void onPaste(std::string const& c) {
-        if(pasteCallback != nullptr)
-            pasteCallback(c);
+
+    // Reading the clipboard may be a round trip to the selection owner on X11, so the backend defers it to the end of the poll
+    // and on X11 reads it on a worker, delivering the paste on a later poll. Elsewhere the native read may still block the poll.
+    void requestPaste() { pasteRequested = true; }
+    bool takePasteRequest() {
+        bool requested = pasteRequested;
+        pasteRequested = false;
+        return requested;
+    }
+
+    // Largest length up to maxLength not splitting a UTF-8 sequence
+    static size_t getUtf8Boundary(std::string_view text, size_t maxLength) {
+        if(maxLength >= text.size())
+            return text.size();
+        size_t length = maxLength;
+        while(length > 0 && ((unsigned char)text[length] & 0xC0) == 0x80)
+            length--;
+        return length;
     }
     void onGamepadState(int id, bool connected) {
-        if(gamepadStateCallback != nullptr)
-            gamepadStateCallback(id, connected);
+        for(auto it = gamepadAxisStates.begin(); it != gamepadAxisStates.end(); it++) {
+            if(it->id == id) {
+                gamepadAxisStates.erase(it);
+                break;
+            }
+        }
+        auto ev = makeEvent(GameWindowEventType::GAMEPAD_STATE);
+        ev.gamepadState = {id, connected};
+        queueEvent(ev);
     }
     void onGamepadButton(int id, GamepadButtonId btn, bool pressed) {
-        if(gamepadButtonCallback != nullptr && btn != GamepadButtonId::UNKNOWN)
-            gamepadButtonCallback(id, btn, pressed);
+        if(btn == GamepadButtonId::UNKNOWN)
+            return;
+        auto ev = makeEvent(GameWindowEventType::GAMEPAD_BUTTON);
+        ev.gamepadButton = {id, btn, pressed};
+        queueEvent(ev);
     }
     void onGamepadAxis(int id, GamepadAxisId axis, float val) {
-        if(gamepadAxisCallback != nullptr && axis != GamepadAxisId::UNKNOWN)
-            gamepadAxisCallback(id, axis, val);
+        if(axis == GamepadAxisId::UNKNOWN)
+            return;
+        filterGamepadAxis(id, axis, val);
+    }
+    void onFocus(bool focused) {
+        auto ev = makeEvent(GameWindowEventType::FOCUS);
+        ev.focus = {focused};
+        queueEvent(ev);
+    }
+    void onVisibility(bool visible) {
+        auto ev = makeEvent(GameWindowEventType::VISIBILITY);
+        ev.visibility = {visible};
+        queueEvent(ev);
     }
     void onClose() {
-        if(closeCallback != nullptr)
-            closeCallback();
+        queueEvent(makeEvent(GameWindowEventType::CLOSE));
     }
 };
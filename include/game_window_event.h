@@ -0,0 +1,239 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "key_mapping.h"
+
+enum class KeyAction {
+    PRESS,
+    REPEAT,
+    RELEASE
+};
+enum class MouseButtonAction {
+    PRESS,
+    RELEASE
+};
+enum class GamepadButtonId {
+    A,
+    B,
+    X,
+    Y,
+    LB,
+    RB,
+    BACK,
+    START,
+    GUIDE,
+    LEFT_STICK,
+    RIGHT_STICK,
+    DPAD_UP,
+    DPAD_RIGHT,
+    DPAD_DOWN,
+    DPAD_LEFT,
+    UNKNOWN = -1
+};
+enum class GamepadAxisId {
+    LEFT_X,
+    LEFT_Y,
+    RIGHT_X,
+    RIGHT_Y,
+    LEFT_TRIGGER,
+    RIGHT_TRIGGER,
+    UNKNOWN = -1
+};
+
+// Snapshot of one gamepad, see GameWindow::getGamepadState
+struct GamepadState {
+    bool connected = false;
+    // Bit (1 << GamepadButtonId) per pressed button
+    uint32_t buttons = 0;
+    // Indexed by GamepadAxisId
+    float axes[6] = {};
+    // Increases with every change of the gamepad
+    uint32_t sequence = 0;
+
+    bool isPressed(GamepadButtonId button) const { return button != GamepadButtonId::UNKNOWN && (buttons & (1u << (int)button)) != 0; }
+};
+
+enum class TouchPhase : uint8_t {
+    START,
+    UPDATE,
+    // Active, but didn't change since the previous touch frame
+    STATIONARY,
+    END
+};
+
+// One contact of a touch frame, see GameWindow::getTouchFrame
+struct TouchPoint {
+    // Touch slot, contiguous from 0 and reused once the contact ended
+    int id;
+    double x, y;
+    float pressure;
+    TouchPhase phase;
+    uint64_t timestamp;
+};
+
+// Size and scale of the drawable, see GameWindow::getSurface
+struct WindowSurface {
+    // Of the default framebuffer
+    int pixelWidth, pixelHeight;
+    // In window coordinates, equal to the pixels where the platform doesn't scale windows
+    int width, height;
+    // Content scale of the display, e.g. 2 on hidpi screens
+    float scaleX, scaleY;
+
+    bool operator==(WindowSurface const& o) const {
+        return pixelWidth == o.pixelWidth && pixelHeight == o.pixelHeight && width == o.width && height == o.height && scaleX == o.scaleX && scaleY == o.scaleY;
+    }
+    bool operator!=(WindowSurface const& o) const { return !(*this == o); }
+};
+
+enum class GameWindowEventType : uint8_t {
+    // Sent at the end of a poll in which the pixel size changed, followed by SURFACE_CHANGED
+    WINDOW_SIZE,
+    // Sent at the end of a poll in which any value of the surface changed
+    SURFACE_CHANGED,
+    MOUSE_BUTTON,
+    MOUSE_POSITION,
+    MOUSE_RELATIVE_POSITION,
+    MOUSE_SCROLL,
+    TOUCH_START,
+    TOUCH_UPDATE,
+    TOUCH_END,
+    // Sent at the end of a poll in which the touches changed
+    TOUCH_FRAME,
+    KEYBOARD,
+    KEYBOARD_TEXT,
+    DROP,
+    PASTE,
+    GAMEPAD_STATE,
+    GAMEPAD_BUTTON,
+    GAMEPAD_AXIS,
+    FOCUS,
+    VISIBILITY,
+    CLOSE
+};
+
+// Plain event record, the active member of the union is selected by type
+struct GameWindowEvent {
+    GameWindowEventType type;
+    // Monotonic nanoseconds, see GameWindow::getTimestamp
+    uint64_t timestamp;
+    union {
+        struct {
+            int width, height;
+        } windowSize;
+        WindowSurface surface;
+        struct {
+            double x, y;
+            int button;
+            MouseButtonAction action;
+        } mouseButton;
+        // MOUSE_POSITION and MOUSE_RELATIVE_POSITION
+        struct {
+            double x, y;
+        } mousePosition;
+        struct {
+            double x, y, dx, dy;
+        } mouseScroll;
+        // TOUCH_START, TOUCH_UPDATE and TOUCH_END
+        struct {
+            int id;
+            double x, y;
+            float pressure;
+        } touch;
+        struct {
+            KeyCode key;
+            KeyAction action;
+            int mods;
+        } keyboard;
+        // KEYBOARD_TEXT, DROP and PASTE, a range in the string data of the owning EventBuffer
+        struct {
+            uint32_t offset, length;
+        } text;
+        struct {
+            int id;
+            bool connected;
+        } gamepadState;
+        struct {
+            int id;
+            GamepadButtonId button;
+            bool pressed;
+        } gamepadButton;
+        struct {
+            int id;
+            GamepadAxisId axis;
+            float value;
+        } gamepadAxis;
+        struct {
+            bool focused;
+        } focus;
+        // False while minimized or fully occluded
+        struct {
+            bool visible;
+        } visibility;
+    };
+};
+
+// Reusable contiguous event storage, clearing keeps the allocated capacity
+class EventBuffer {
+private:
+    std::vector<GameWindowEvent> events;
+    std::string strings;
+
+public:
+    void clear() {
+        events.clear();
+        strings.clear();
+    }
+
+    void reserve(size_t eventCount, size_t stringBytes) {
+        events.reserve(eventCount);
+        strings.reserve(stringBytes);
+    }
+
+    size_t size() const { return events.size(); }
+
+    bool empty() const { return events.empty(); }
+
+    const GameWindowEvent& operator[](size_t i) const { return events[i]; }
+
+    const GameWindowEvent* begin() const { return events.data(); }
+
+    const GameWindowEvent* end() const { return events.data() + events.size(); }
+
+    // Text of all events, GameWindowEvent::text is relative to it
+    std::string_view getStrings() const { return strings; }
+
+    // Text of a KEYBOARD_TEXT, DROP or PASTE event, valid until the buffer is cleared
+    std::string_view getText(const GameWindowEvent& ev) const {
+        return std::string_view(strings.data() + ev.text.offset, ev.text.length);
+    }
+
+    GameWindowEvent& push(GameWindowEventType type, uint64_t timestamp) {
+        GameWindowEvent& ev = events.emplace_back();
+        ev.type = type;
+        ev.timestamp = timestamp;
+        return ev;
+    }
+
+    GameWindowEvent& pushText(GameWindowEventType type, uint64_t timestamp, std::string_view text) {
+        GameWindowEvent& ev = push(type, timestamp);
+        ev.text.offset = (uint32_t)strings.size();
+        ev.text.length = (uint32_t)text.size();
+        strings.append(text);
+        return ev;
+    }
+
+    // Copies a record, text events get their text stored in this buffer
+    GameWindowEvent& push(const GameWindowEvent& src, std::string_view text) {
+        GameWindowEvent& ev = events.emplace_back(src);
+        if(src.type == GameWindowEventType::KEYBOARD_TEXT || src.type == GameWindowEventType::DROP || src.type == GameWindowEventType::PASTE) {
+            ev.text.offset = (uint32_t)strings.size();
+            ev.text.length = (uint32_t)text.size();
+            strings.append(text);
+        }
+        return ev;
+    }
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "game_window_event.h"
+
+// Single listener for all window events, replaces the per event callbacks while set
+class GameWindowEventSink {
+
+public:
+    virtual ~GameWindowEventSink() {}
+
+    virtual void onDraw() {}
+    virtual void onWindowSizeChanged(int w, int h) {}
+    // At most once per poll, after onWindowSizeChanged
+    virtual void onSurfaceChanged(WindowSurface const& surface) {}
+    virtual void onMouseButton(double x, double y, int button, MouseButtonAction action) {}
+    virtual void onMousePosition(double x, double y) {}
+    // Used when the cursor is disabled
+    virtual void onMouseRelativePosition(double x, double y) {}
+    virtual void onMouseScroll(double x, double y, double dx, double dy) {}
+    virtual void onTouchStart(int id, double x, double y) {}
+    virtual void onTouchUpdate(int id, double x, double y) {}
+    virtual void onTouchEnd(int id, double x, double y) {}
+    // All active contacts, plus the ones which ended since the previous frame
+    virtual void onTouchFrame(TouchPoint const* points, size_t count) {}
+    virtual void onKeyboard(KeyCode key, KeyAction action, int mods) {}
+    virtual void onKeyboardText(std::string const& c) {}
+    // The text is only valid during the call, forwards to onKeyboardText by default
+    virtual void onTextInput(std::string_view text) { onKeyboardText(std::string(text)); }
+    virtual void onDrop(std::string const& path) {}
+    virtual void onPaste(std::string const& c) {}
+    virtual void onGamepadState(int id, bool connected) {}
+    virtual void onGamepadButton(int id, GamepadButtonId btn, bool pressed) {}
+    virtual void onGamepadAxis(int id, GamepadAxisId axis, float val) {}
+    virtual void onFocus(bool focused) {}
+    virtual void onVisibility(bool visible) {}
+    virtual void onClose() {}
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "game_window_shared_context.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Reads back the frames a window presents without stalling the render thread, see GameWindow::setFrameCapture
+// Each frame is copied into one of a ring of pixel buffers and handed out by the first capture after the gpu finished the copy,
+// with the default ring of three frame N is captured while frame N-1 or at the latest N-2 is handed out.
+// Frames are dropped instead of waited for while every buffer is still in flight.
+// Needs OpenGL 3.0 or OpenGL ES 3.0, on older contexts each frame is read synchronously and the size option is ignored.
+// Create, use and destroy it with the context of the window current.
+class GameWindowFrameCapture {
+
+public:
+    enum class PixelFormat {
+        RGBA,
+        BGRA
+    };
+
+    struct Options {
+        // Size of the captured frames, scaled with linear filtering, 0 keeps the size of the framebuffer
+        int width = 0, height = 0;
+        PixelFormat format = PixelFormat::RGBA;
+        // Frames in flight, also the latency of a frame in frames
+        int ringSize = 3;
+    };
+
+    struct Frame {
+        // Rows from bottom to top, only valid during the callback
+        const uint8_t* pixels;
+        int width, height;
+        size_t stride;
+        PixelFormat format;
+        // Time of the capture, see GameWindow::getTimestamp
+        uint64_t timestamp;
+        // Increases with every frame, gaps are dropped frames
+        uint64_t index;
+    };
+
+    using FrameCallback = std::function<void(Frame const& frame)>;
+
+private:
+    struct Slot {
+        unsigned int buffer = 0;
+        size_t size = 0;
+        int width = 0, height = 0;
+        uint64_t timestamp = 0, index = 0;
+        GameWindowFence fence;
+        bool pending = false;
+    };
+
+    Options options;
+    FrameCallback callback;
+    std::vector<Slot> slots;
+    // Slot the next frame goes to, the oldest one in flight
+    size_t nextSlot = 0;
+    uint64_t frameIndex = 0;
+    uint64_t droppedFrames = 0;
+    bool asynchronous = false;
+    // Set if the context has GL_PIXEL_PACK_BUFFER, which the synchronous capture has to unbind
+    bool packBuffers = false;
+    // Set if the context can't read BGRA itself
+    bool swizzle = false;
+    // Target of the downscale
+    unsigned int framebuffer = 0, renderbuffer = 0;
+    int renderbufferWidth = 0, renderbufferHeight = 0;
+    // Frames of synchronous captures and swizzled frames
+    std::vector<uint8_t> readback, scratch;
+
+    void getFrameSize(int framebufferWidth, int framebufferHeight, int& width, int& height) const;
+    void readPixels(int width, int height, void* pixels);
+    void deliver(const uint8_t* pixels, int width, int height, uint64_t timestamp, uint64_t index);
+    void deliver(Slot& slot);
+
+public:
+    // Throws std::runtime_error if the context lacks glReadPixels
+    GameWindowFrameCapture(Options options, FrameCallback callback);
+
+    ~GameWindowFrameCapture();
+
+    GameWindowFrameCapture(GameWindowFrameCapture const&) = delete;
+
+    GameWindowFrameCapture& operator=(GameWindowFrameCapture const&) = delete;
+
+    // Captures the back buffer of the current context and hands out the frames the gpu finished
+    // Called by the window before presenting, reads the default framebuffer whatever framebuffer is bound
+    void capture(int framebufferWidth, int framebufferHeight);
+
+    // Hands out the frames the gpu finished, with wait all frames in flight
+    void flush(bool wait);
+
+    uint64_t getDroppedFrames() const { return droppedFrames; }
+
+    // False if frames are read synchronously, see the class comment
+    bool isAsynchronous() const { return asynchronous; }
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "game_window.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+// Pumps the native events of a window on a separate thread, the translated events are
+// handed to the render thread through a lock-free single producer single consumer queue.
+// Gamepads are polled by the window's pollEvents and move onto the pumping thread as well.
+// GLFW and SDL3 have to pump on the main thread (required on macOS), use run() there and render on another thread.
+class GameWindowInputThread {
+
+private:
+    struct Queue;
+
+    std::shared_ptr<GameWindow> window;
+    std::unique_ptr<Queue> queue;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<int64_t> pollIntervalUs{1000};
+    std::atomic<uint64_t> droppedEvents{0};
+    // Only used by the pumping thread
+    EventBuffer captured;
+    // Rest of a paste which didn't fit into the queue and the events after it, pushed by the next pumps
+    EventBuffer backlog, retried;
+
+    void forwardEvent(GameWindowEvent const& ev, std::string_view text);
+    bool pushTextEvent(GameWindowEvent const& ev, std::string_view text);
+    void dropEvent();
+    void drainQueue();
+
+public:
+    // capacity is the number of events the queue holds before events are dropped, text gets 4 bytes per event
+    // Pastes are split into paste events of about capacity bytes, which wait for the render thread to drain the queue instead of being dropped
+    explicit GameWindowInputThread(std::shared_ptr<GameWindow> window, size_t capacity = 4096);
+
+    ~GameWindowInputThread();
+
+    // Spawns a thread which pumps the events until stop is called
+    void start();
+
+    // Pumps the events on the calling thread until stop is called
+    void run();
+
+    // Pumps the events once on the calling thread
+    void pumpEvents();
+
+    void stop();
+
+    bool isRunning() const { return running; }
+
+    void setPollInterval(std::chrono::microseconds interval) { pollIntervalUs = interval.count(); }
+
+    // Render thread side, never blocks apart from the frame pacing with FramePacing::lateInputSampling
+    // Invokes the callbacks or sink of the window for all queued events
+    size_t dispatchEvents();
+
+    // Render thread side, never blocks. Moves all queued events into the buffer instead
+    void pollEvents(EventBuffer& buffer);
+
+    // Events lost because the render thread didn't drain the queue in time
+    uint64_t getDroppedEventCount() const { return droppedEvents; }
+};
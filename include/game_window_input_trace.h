@@ -0,0 +1,88 @@
+#pragma once
+
+#include "game_window.h"
+#include <memory>
+#include <string>
+
+// Binary trace of the events a window dispatched, one chunk per poll:
+// a file header, then per chunk a header, the event records and the text of the chunk's text events.
+// Records are stored with the layout of GameWindowEvent, traces only load in builds using the same layout.
+//
+// Records the events after coalescing and filtering, exactly as the callbacks see them.
+// The file is memory mapped and grown in steps, a trace cut short by a crash stays readable up to the last complete poll.
+class GameWindowInputTraceRecorder {
+
+private:
+    int fd = -1;
+    char* mapping = nullptr;
+    size_t capacity = 0, size = 0;
+    // Events of the running poll
+    EventBuffer pending;
+
+    // Grows the file and its mapping, false if that failed
+    bool reserve(size_t bytes);
+
+public:
+    // Throws std::runtime_error if the file can't be created
+    explicit GameWindowInputTraceRecorder(std::string const& path);
+
+    ~GameWindowInputTraceRecorder();
+
+    GameWindowInputTraceRecorder(GameWindowInputTraceRecorder const&) = delete;
+
+    GameWindowInputTraceRecorder& operator=(GameWindowInputTraceRecorder const&) = delete;
+
+    // Called by the window for every dispatched event
+    void record(GameWindowEvent const& ev, std::string_view text);
+
+    // Called by the window at the end of every poll, writes the recorded events as one chunk
+    void endPoll(uint64_t timestamp);
+
+    // Bytes written so far
+    size_t getSize() const { return size; }
+};
+
+// Feeds a trace back into a window at the end of its polls, see GameWindow::setInputTracePlayer
+class GameWindowInputTracePlayer {
+
+public:
+    enum class Speed {
+        // Chunks are due at the time relative to the first poll they were recorded at
+        RECORDED,
+        // One chunk per poll, the timestamps are replaced by the time of dispatch
+        MAXIMUM
+    };
+
+    struct Chunk {
+        const GameWindowEvent* events;
+        size_t eventCount;
+        // Text of the events, GameWindowEvent::text is relative to this
+        const char* strings;
+    };
+
+private:
+    struct Trace;
+
+    std::unique_ptr<Trace> trace;
+    Speed speed;
+    size_t offset = 0;
+    uint64_t firstPollTimestamp = 0;
+    uint64_t replayStartTimestamp = 0;
+
+public:
+    // Throws std::runtime_error if the file can't be read or was recorded by an incompatible build
+    explicit GameWindowInputTracePlayer(std::string const& path, Speed speed = Speed::RECORDED);
+
+    ~GameWindowInputTracePlayer();
+
+    // Returns false if no further chunk is due at now
+    bool nextChunk(uint64_t now, Chunk& chunk);
+
+    // Moves a recorded timestamp to the timeline of the replay
+    uint64_t mapTimestamp(uint64_t timestamp, uint64_t now) const;
+
+    bool isFinished() const;
+
+    // Starts over from the first chunk
+    void rewind();
+};
@@ -2,6 +2,7 @@
 
 #include "game_window.h"
 #include "game_window_error_handler.h"
+#include "game_window_metrics.h"
 #include <memory>
 
 class GameWindowManager {
@@ -41,4 +42,25 @@ public:
     }
 
     const std::shared_ptr<GameWindowErrorHandler>& getErrorHandler() { return errorhandler; }
+
+    // Timestamps of the startup of the process, see GameWindow::getTimestamp, 0 until the phase happened
+    // Only the first window counts, phases are independent of the metrics and always recorded
+    struct StartupTimings {
+        // Around the creation of the manager by getManager, the fallback manager keeps probing the backends after it returned
+        uint64_t managerCreationStart = 0, managerCreated = 0;
+        // Around that probe on the worker thread of the fallback manager, 0 with the other managers
+        uint64_t backendProbeStart = 0, backendProbed = 0;
+        // Around the createWindow call which created the first window
+        uint64_t firstWindowCreationStart = 0, firstWindowCreated = 0;
+        // The context of a window was made current for the first time
+        uint64_t firstContextCurrent = 0;
+        // The first swapBuffers presented its frame
+        uint64_t firstSwap = 0;
+    };
+
+    static StartupTimings getStartupTimings();
+
+    // Copy of the process wide metrics, may be called from any thread
+    // Values only grow, export the differences between two snapshots for rates
+    GameWindowMetrics getMetricsSnapshot() const;
 };
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "game_window_event.h"
+#include <cstddef>
+#include <cstdint>
+
+// Process wide counters and histograms, see GameWindowManager::getMetricsSnapshot
+// Only collected by builds with GAMEWINDOW_METRICS, the snapshot of other builds has enabled set to false and stays empty
+struct GameWindowMetrics {
+    // Bucket 0 counts the zeros, bucket i the values in [2^(i-1), 2^i), the last one everything above
+    static constexpr int HISTOGRAM_BUCKETS = 40;
+    static constexpr int EVENT_TYPE_COUNT = (int)GameWindowEventType::CLOSE + 1;
+
+    enum class HistogramId {
+        // Nanoseconds spent pumping and dispatching the events of a poll, excluding frame pacing
+        POLL_DURATION,
+        // Events produced by a poll
+        EVENTS_PER_POLL,
+        // Nanoseconds the native swap took, includes the wait for the vblank of drivers honoring the swap interval
+        SWAP_DURATION,
+        // Nanoseconds the frame pacer slept, the vblank wait of emulated swap intervals and frame rate caps
+        FRAME_PACING_WAIT,
+        // Nanoseconds waited for a contended x11 event or present lock
+        X11_LOCK_WAIT,
+        // Nanoseconds spent reading the gamepads of a poll
+        GAMEPAD_POLL_DURATION,
+        COUNT
+    };
+
+    enum class CounterId {
+        // Relative mouse motion merged into the single event of its poll
+        COALESCED_EVENTS,
+        // Gamepad axis changes smaller than the change threshold of the axis filter
+        FILTERED_EVENTS,
+        // Events GameWindowInputThread had no room for
+        DROPPED_EVENTS,
+        COUNT
+    };
+
+    struct Histogram {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        uint64_t buckets[HISTOGRAM_BUCKETS] = {};
+
+        // Smallest value of the bucket
+        static uint64_t getBucketLowerBound(int bucket) { return bucket == 0 ? 0 : (uint64_t)1 << (bucket - 1); }
+    };
+
+    bool enabled = false;
+    Histogram histograms[(int)HistogramId::COUNT];
+    uint64_t counters[(int)CounterId::COUNT] = {};
+    // Dispatched events per GameWindowEventType, divide by the count of POLL_DURATION for the average per poll
+    uint64_t events[EVENT_TYPE_COUNT] = {};
+
+    Histogram const& getHistogram(HistogramId id) const { return histograms[(int)id]; }
+    uint64_t getCounter(CounterId id) const { return counters[(int)id]; }
+    uint64_t getEventCount(GameWindowEventType type) const { return events[(int)type]; }
+
+    // Stable snake case names for exporting, nullptr for invalid ids
+    static const char* getName(HistogramId id);
+    static const char* getName(CounterId id);
+    static const char* getName(GameWindowEventType type);
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// Offscreen context sharing textures and buffers with the window it was created from
+// Create it on the thread owning the window, then make it current on a single worker thread
+// The last reference may be dropped on the worker, GLFW and SDL3 destroy their hidden window during the next poll of a window,
+// with the other backends it is destroyed right away
+class GameWindowSharedContext {
+
+public:
+    virtual ~GameWindowSharedContext() {}
+
+    // Binds the context to the calling thread, false releases it again
+    virtual void makeCurrent(bool active) = 0;
+};
+
+// Marks the end of the commands issued so far, so another context knows when an upload is complete
+// Creating and destroying a fence requires a current context, falls back to glFinish if sync objects are unavailable
+class GameWindowFence {
+private:
+    void* sync = nullptr;
+
+public:
+    GameWindowFence() {}
+
+    GameWindowFence(GameWindowFence const&) = delete;
+
+    GameWindowFence(GameWindowFence&& other) : sync(other.sync) { other.sync = nullptr; }
+
+    GameWindowFence& operator=(GameWindowFence const&) = delete;
+
+    GameWindowFence& operator=(GameWindowFence&& other);
+
+    ~GameWindowFence();
+
+    // Inserts a fence after the commands of the current context and flushes them
+    static GameWindowFence create();
+
+    // Doesn't block
+    bool isSignaled();
+
+    // Blocks the calling thread up to timeout nanoseconds, returns whether the fence was signaled
+    bool wait(uint64_t timeout);
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 enum class KeyCode {
     UNKNOWN = 0,
     BACK = 4,
@@ -115,4 +117,93 @@ enum class KeyCode {
 #define KEY_MOD_SUPER (1 << 2)
 #define KEY_MOD_ALT (1 << 3)
 #define KEY_MOD_CAPSLOCK (1 << 4)
-#define KEY_MOD_NUMLOCK (1 << 5)
\ No newline at end of file
+#define KEY_MOD_NUMLOCK (1 << 5)
+
+// All KeyCode values are below this, RIGHT_* keys set bit 8
+constexpr int KEY_CODE_COUNT = 512;
+
+// A native key code, or count consecutive ones, and the KeyCode it translates to
+// Aliases are only used for translating to a KeyCode, e.g. the keypad enter key
+struct NativeKeyMapping {
+    int native;
+    KeyCode key;
+    int count;
+    bool alias;
+};
+
+constexpr NativeKeyMapping mapKey(int native, KeyCode key) {
+    return {native, key, 1, false};
+}
+
+constexpr NativeKeyMapping mapKeys(int native, KeyCode key, int count) {
+    return {native, key, count, false};
+}
+
+constexpr NativeKeyMapping mapKeyAlias(int native, KeyCode key, int count = 1) {
+    return {native, key, count, true};
+}
+
+// Dense native code -> KeyCode table for the native codes First to Last, generated at compile time from a mapping list
+// Native codes below 256 without a mapping optionally translate to the KeyCode of the same value
+template <int First, int Last>
+class NativeKeyTable {
+private:
+    KeyCode keys[Last - First + 1] = {};
+
+public:
+    template <size_t N>
+    constexpr NativeKeyTable(NativeKeyMapping const (&mappings)[N], bool identity = false) {
+        if(identity) {
+            for(int i = First < 0 ? 0 : First; i <= Last && i < 256; i++)
+                keys[i - First] = (KeyCode)i;
+        }
+        for(size_t m = 0; m < N; m++) {
+            for(int i = 0; i < mappings[m].count; i++) {
+                int native = mappings[m].native + i;
+                if(native >= First && native <= Last)
+                    keys[native - First] = (KeyCode)((int)mappings[m].key + i);
+            }
+        }
+    }
+
+    constexpr KeyCode operator[](int native) const {
+        return native >= First && native <= Last ? keys[native - First] : KeyCode::UNKNOWN;
+    }
+};
+
+// KeyCode -> native code table from the same mapping list, aliases are skipped, Unknown is used for unmapped keys
+template <int Unknown>
+class KeyCodeTable {
+private:
+    int natives[KEY_CODE_COUNT] = {};
+
+public:
+    template <size_t N>
+    constexpr KeyCodeTable(NativeKeyMapping const (&mappings)[N]) {
+        for(int i = 0; i < KEY_CODE_COUNT; i++)
+            natives[i] = Unknown;
+        for(size_t m = 0; m < N; m++) {
+            if(mappings[m].alias)
+                continue;
+            for(int i = 0; i < mappings[m].count; i++) {
+                int key = (int)mappings[m].key + i;
+                if(key >= 0 && key < KEY_CODE_COUNT && natives[key] == Unknown)
+                    natives[key] = mappings[m].native + i;
+            }
+        }
+    }
+
+    constexpr int operator[](KeyCode key) const {
+        return (int)key >= 0 && (int)key < KEY_CODE_COUNT ? natives[(int)key] : Unknown;
+    }
+
+    // Every KeyCode must translate back to itself, so a key reported by the backend can be fed back into it
+    template <int First, int Last>
+    constexpr bool isInverseOf(NativeKeyTable<First, Last> const& forward) const {
+        for(int i = 0; i < KEY_CODE_COUNT; i++) {
+            if(natives[i] != Unknown && (int)forward[natives[i]] != i)
+                return false;
+        }
+        return true;
+    }
+};
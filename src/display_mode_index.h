@@ -0,0 +1,72 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <game_window.h>
+
+// Fullscreen modes of each monitor next to their native modes, built on first use
+// Dropped when a monitor is connected or disconnected, ids handed out before are rejected afterwards
+template <typename Monitor, typename NativeMode>
+class DisplayModeIndex {
+private:
+    struct MonitorModes {
+        Monitor monitor;
+        std::vector<FullscreenMode> modes;
+        std::vector<NativeMode> nativeModes;
+    };
+    // A deque keeps the lists handed out by getModes in place while other monitors are added
+    std::deque<MonitorModes> monitors;
+    // 0 is never used, so default constructed modes don't match
+    uint32_t nextGeneration = 1;
+
+    MonitorModes const* findMonitor(Monitor monitor) const {
+        for (auto& m : monitors) {
+            if (m.monitor == monitor)
+                return &m;
+        }
+        return nullptr;
+    }
+
+public:
+    void invalidate() {
+        monitors.clear();
+    }
+
+    // Calls fill(std::vector<NativeMode>&) if the monitor isn't indexed yet and convert(NativeMode const&) for each of its modes
+    template <typename Fill, typename Convert>
+    std::vector<FullscreenMode> const& getModes(Monitor monitor, Fill&& fill, Convert&& convert) {
+        if (auto m = findMonitor(monitor))
+            return m->modes;
+        auto& m = monitors.emplace_back();
+        m.monitor = monitor;
+        fill(m.nativeModes);
+        uint32_t generation = nextGeneration++;
+        m.modes.reserve(m.nativeModes.size());
+        for (size_t i = 0; i < m.nativeModes.size(); i++) {
+            FullscreenMode mode = convert(m.nativeModes[i]);
+            mode.id = (int)i;
+            mode.generation = generation;
+            mode.description = mode.getDescription();
+            m.modes.push_back(mode);
+        }
+        return m.modes;
+    }
+
+    // Modes returned by getModes since the last invalidate are found by id, others like persisted ones by their properties or description
+    // nullptr if the monitor wasn't indexed by getModes or has no such mode
+    NativeMode const* findNativeMode(Monitor monitor, FullscreenMode const& mode) const {
+        auto m = findMonitor(monitor);
+        if (m == nullptr)
+            return nullptr;
+        if (mode.id >= 0 && mode.id < (int)m->modes.size() && m->modes[mode.id].generation == mode.generation)
+            return &m->nativeModes[mode.id];
+        for (size_t i = 0; i < m->modes.size(); i++) {
+            auto& candidate = m->modes[i];
+            bool sameProperties = candidate.width == mode.width && candidate.height == mode.height && candidate.refreshRate == mode.refreshRate && candidate.pixelDensity == mode.pixelDensity;
+            if (sameProperties || (!mode.description.empty() && candidate.description == mode.description))
+                return &m->nativeModes[i];
+        }
+        return nullptr;
+    }
+};
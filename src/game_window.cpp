@@ -0,0 +1,580 @@
+#include <game_window.h>
+#include <game_window_input_trace.h>
+#include <game_window_frame_capture.h>
+#include "game_window_metrics_collector.h"
+#include "startup_timings.h"
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+void GameWindow::deliverEvent(GameWindowEvent const& ev, std::string_view text) {
+    GameWindowMetricsCollector::countEvent(ev.type);
+    lastEventTimestamp = ev.timestamp;
+    if(firstFrameInputTimestamp == 0)
+        firstFrameInputTimestamp = lastEventTimestamp;
+    lastFrameInputTimestamp = lastEventTimestamp;
+    if(ev.type == GameWindowEventType::KEYBOARD) {
+        int key = (int)ev.keyboard.key;
+        if(key > 0 && key < KEY_CODE_COUNT)
+            keyState.set(key, ev.keyboard.action != KeyAction::RELEASE);
+    } else if(ev.type == GameWindowEventType::MOUSE_BUTTON) {
+        int button = ev.mouseButton.button;
+        if(button >= 0 && button < (int)mouseButtonState.size())
+            mouseButtonState.set(button, ev.mouseButton.action == MouseButtonAction::PRESS);
+    } else if(ev.type == GameWindowEventType::FOCUS) {
+        windowFocused = ev.focus.focused;
+        // Releases happening while unfocused aren't reported
+        if(!windowFocused) {
+            keyState.reset();
+            mouseButtonState.reset();
+        }
+    } else if(ev.type == GameWindowEventType::VISIBILITY) {
+        windowVisible = ev.visibility.visible;
+    } else if(ev.type == GameWindowEventType::GAMEPAD_STATE || ev.type == GameWindowEventType::GAMEPAD_BUTTON || ev.type == GameWindowEventType::GAMEPAD_AXIS) {
+        updateGamepadState(ev);
+    } else if(ev.type == GameWindowEventType::TOUCH_START || ev.type == GameWindowEventType::TOUCH_UPDATE || ev.type == GameWindowEventType::TOUCH_END) {
+        updateTouchFrame(ev);
+    } else if(ev.type == GameWindowEventType::TOUCH_FRAME) {
+        touchFrameDelivered = true;
+    } else if(ev.type == GameWindowEventType::SURFACE_CHANGED) {
+        surface = ev.surface;
+    }
+
+    if(eventBuffer != nullptr) {
+        eventBuffer->push(ev, text);
+        return;
+    }
+    if(eventSink != nullptr) {
+        switch(ev.type) {
+        case GameWindowEventType::WINDOW_SIZE:
+            eventSink->onWindowSizeChanged(ev.windowSize.width, ev.windowSize.height);
+            break;
+        case GameWindowEventType::SURFACE_CHANGED:
+            eventSink->onSurfaceChanged(ev.surface);
+            break;
+        case GameWindowEventType::MOUSE_BUTTON:
+            eventSink->onMouseButton(ev.mouseButton.x, ev.mouseButton.y, ev.mouseButton.button, ev.mouseButton.action);
+            break;
+        case GameWindowEventType::MOUSE_POSITION:
+            eventSink->onMousePosition(ev.mousePosition.x, ev.mousePosition.y);
+            break;
+        case GameWindowEventType::MOUSE_RELATIVE_POSITION:
+            eventSink->onMouseRelativePosition(ev.mousePosition.x, ev.mousePosition.y);
+            break;
+        case GameWindowEventType::MOUSE_SCROLL:
+            eventSink->onMouseScroll(ev.mouseScroll.x, ev.mouseScroll.y, ev.mouseScroll.dx, ev.mouseScroll.dy);
+            break;
+        case GameWindowEventType::TOUCH_START:
+            eventSink->onTouchStart(ev.touch.id, ev.touch.x, ev.touch.y);
+            break;
+        case GameWindowEventType::TOUCH_UPDATE:
+            eventSink->onTouchUpdate(ev.touch.id, ev.touch.x, ev.touch.y);
+            break;
+        case GameWindowEventType::TOUCH_END:
+            eventSink->onTouchEnd(ev.touch.id, ev.touch.x, ev.touch.y);
+            break;
+        case GameWindowEventType::TOUCH_FRAME:
+            eventSink->onTouchFrame(touchFrame.data(), touchFrame.size());
+            break;
+        case GameWindowEventType::KEYBOARD:
+            eventSink->onKeyboard(ev.keyboard.key, ev.keyboard.action, ev.keyboard.mods);
+            break;
+        case GameWindowEventType::KEYBOARD_TEXT:
+            eventSink->onTextInput(text);
+            break;
+        case GameWindowEventType::DROP:
+            eventSink->onDrop(std::string(text));
+            break;
+        case GameWindowEventType::PASTE:
+            eventSink->onPaste(std::string(text));
+            break;
+        case GameWindowEventType::GAMEPAD_STATE:
+            eventSink->onGamepadState(ev.gamepadState.id, ev.gamepadState.connected);
+            break;
+        case GameWindowEventType::GAMEPAD_BUTTON:
+            eventSink->onGamepadButton(ev.gamepadButton.id, ev.gamepadButton.button, ev.gamepadButton.pressed);
+            break;
+        case GameWindowEventType::GAMEPAD_AXIS:
+            eventSink->onGamepadAxis(ev.gamepadAxis.id, ev.gamepadAxis.axis, ev.gamepadAxis.value);
+            break;
+        case GameWindowEventType::FOCUS:
+            eventSink->onFocus(ev.focus.focused);
+            break;
+        case GameWindowEventType::VISIBILITY:
+            eventSink->onVisibility(ev.visibility.visible);
+            break;
+        case GameWindowEventType::CLOSE:
+            eventSink->onClose();
+            break;
+        }
+        return;
+    }
+    switch(ev.type) {
+    case GameWindowEventType::WINDOW_SIZE:
+        if(windowSizeCallback != nullptr)
+            windowSizeCallback(ev.windowSize.width, ev.windowSize.height);
+        break;
+    case GameWindowEventType::SURFACE_CHANGED:
+        if(surfaceChangedCallback != nullptr)
+            surfaceChangedCallback(ev.surface);
+        break;
+    case GameWindowEventType::MOUSE_BUTTON:
+        if(mouseButtonCallback != nullptr)
+            mouseButtonCallback(ev.mouseButton.x, ev.mouseButton.y, ev.mouseButton.button, ev.mouseButton.action);
+        break;
+    case GameWindowEventType::MOUSE_POSITION:
+        if(mousePositionCallback != nullptr)
+            mousePositionCallback(ev.mousePosition.x, ev.mousePosition.y);
+        break;
+    case GameWindowEventType::MOUSE_RELATIVE_POSITION:
+        if(mouseRelativePositionCallback != nullptr)
+            mouseRelativePositionCallback(ev.mousePosition.x, ev.mousePosition.y);
+        break;
+    case GameWindowEventType::MOUSE_SCROLL:
+        if(mouseScrollCallback != nullptr)
+            mouseScrollCallback(ev.mouseScroll.x, ev.mouseScroll.y, ev.mouseScroll.dx, ev.mouseScroll.dy);
+        break;
+    case GameWindowEventType::TOUCH_START:
+        if(touchStartCallback != nullptr)
+            touchStartCallback(ev.touch.id, ev.touch.x, ev.touch.y);
+        break;
+    case GameWindowEventType::TOUCH_UPDATE:
+        if(touchUpdateCallback != nullptr)
+            touchUpdateCallback(ev.touch.id, ev.touch.x, ev.touch.y);
+        break;
+    case GameWindowEventType::TOUCH_END:
+        if(touchEndCallback != nullptr)
+            touchEndCallback(ev.touch.id, ev.touch.x, ev.touch.y);
+        break;
+    case GameWindowEventType::TOUCH_FRAME:
+        if(touchFrameCallback != nullptr)
+            touchFrameCallback(touchFrame.data(), touchFrame.size());
+        break;
+    case GameWindowEventType::KEYBOARD:
+        if(keyboardCallback != nullptr)
+            keyboardCallback(ev.keyboard.key, ev.keyboard.action, ev.keyboard.mods);
+        break;
+    case GameWindowEventType::KEYBOARD_TEXT:
+        if(textInputCallback != nullptr)
+            textInputCallback(text);
+        break;
+    case GameWindowEventType::DROP:
+        if(dropCallback != nullptr)
+            dropCallback(std::string(text));
+        break;
+    case GameWindowEventType::PASTE:
+        if(pasteCallback != nullptr)
+            pasteCallback(std::string(text));
+        break;
+    case GameWindowEventType::GAMEPAD_STATE:
+        if(gamepadStateCallback != nullptr)
+            gamepadStateCallback(ev.gamepadState.id, ev.gamepadState.connected);
+        break;
+    case GameWindowEventType::GAMEPAD_BUTTON:
+        if(gamepadButtonCallback != nullptr)
+            gamepadButtonCallback(ev.gamepadButton.id, ev.gamepadButton.button, ev.gamepadButton.pressed);
+        break;
+    case GameWindowEventType::GAMEPAD_AXIS:
+        if(gamepadAxisCallback != nullptr)
+            gamepadAxisCallback(ev.gamepadAxis.id, ev.gamepadAxis.axis, ev.gamepadAxis.value);
+        break;
+    case GameWindowEventType::FOCUS:
+        if(focusCallback != nullptr)
+            focusCallback(ev.focus.focused);
+        break;
+    case GameWindowEventType::VISIBILITY:
+        if(visibilityCallback != nullptr)
+            visibilityCallback(ev.visibility.visible);
+        break;
+    case GameWindowEventType::CLOSE:
+        if(closeCallback != nullptr)
+            closeCallback();
+        break;
+    }
+}
+
+void GameWindow::injectEvent(GameWindowEvent const& ev, std::string_view text) {
+    std::lock_guard<std::mutex> lock(injectedEventsLock);
+    injectedEvents.push(ev, text);
+    hasInjectedEvents.store(true, std::memory_order_release);
+}
+
+void GameWindow::beginPollEvents() {
+    // GameWindowInputThread paces the consuming thread instead
+    if(framePacing.lateInputSampling && captureBuffer == nullptr)
+        paceFrame();
+#ifdef GAMEWINDOW_METRICS
+    // After pacing, the wait is recorded on its own
+    pollStartTimestamp = getTimestamp();
+    pollStartEventCount = queuedEventCount;
+#endif
+}
+
+void GameWindow::endPollEvents() {
+    if(tracePlayer != nullptr)
+        replayTrace();
+    if(hasInjectedEvents.load(std::memory_order_acquire))
+        dispatchInjectedEvents();
+    if(hasPendingMouseRelative) {
+        hasPendingMouseRelative = false;
+        GameWindowMetricsCollector::add(GameWindowMetricsCollector::CounterId::COALESCED_EVENTS, pendingMouseRelativeCount - 1);
+        pendingMouseRelativeCount = 0;
+        GameWindowEvent ev;
+        ev.type = GameWindowEventType::MOUSE_RELATIVE_POSITION;
+        ev.timestamp = pendingMouseRelativeTimestamp;
+        ev.mousePosition = {pendingMouseRelativeX, pendingMouseRelativeY};
+        pendingMouseRelativeX = pendingMouseRelativeY = 0.0;
+        queueEvent(ev);
+    }
+    if(captureBuffer != nullptr) {
+        if(!pendingMouseRelativeHistory.empty()) {
+            // Before the event is handed to the consuming thread, see getMouseRelativeHistory
+            std::lock_guard<std::mutex> lock(capturedMouseRelativeHistoryLock);
+            capturedMouseRelativeHistory.insert(capturedMouseRelativeHistory.end(), pendingMouseRelativeHistory.begin(), pendingMouseRelativeHistory.end());
+            pendingMouseRelativeHistory.clear();
+        }
+    } else {
+        mouseRelativeHistory.swap(pendingMouseRelativeHistory);
+        pendingMouseRelativeHistory.clear();
+    }
+    if(touchFrameChanged) {
+        touchFrameChanged = false;
+        queueEvent(makeEvent(GameWindowEventType::TOUCH_FRAME));
+    }
+    if(pendingSurface != reportedSurface) {
+        if(pendingSurface.pixelWidth != reportedSurface.pixelWidth || pendingSurface.pixelHeight != reportedSurface.pixelHeight) {
+            auto ev = makeEvent(GameWindowEventType::WINDOW_SIZE);
+            ev.windowSize = {pendingSurface.pixelWidth, pendingSurface.pixelHeight};
+            queueEvent(ev);
+        }
+        reportedSurface = pendingSurface;
+        auto ev = makeEvent(GameWindowEventType::SURFACE_CHANGED);
+        ev.surface = reportedSurface;
+        queueEvent(ev);
+    }
+    if(traceRecorder != nullptr)
+        endTracePoll();
+#ifdef GAMEWINDOW_METRICS
+    GameWindowMetricsCollector::record(GameWindowMetricsCollector::HistogramId::POLL_DURATION, getTimestamp() - pollStartTimestamp);
+    GameWindowMetricsCollector::record(GameWindowMetricsCollector::HistogramId::EVENTS_PER_POLL, queuedEventCount - pollStartEventCount);
+#endif
+}
+
+void GameWindow::takeCapturedMouseRelativeHistory() {
+    mouseRelativeHistory.clear();
+    std::lock_guard<std::mutex> lock(capturedMouseRelativeHistoryLock);
+    mouseRelativeHistory.swap(capturedMouseRelativeHistory);
+}
+
+void GameWindow::dispatchInjectedEvents() {
+    {
+        std::lock_guard<std::mutex> lock(injectedEventsLock);
+        std::swap(injectedEvents, dispatchedInjectedEvents);
+        hasInjectedEvents.store(false, std::memory_order_relaxed);
+    }
+    // Through the same helpers as native events, so coalescing, filtering and touch frames apply
+    for(auto& ev : dispatchedInjectedEvents) {
+        setEventTimestamp(ev.timestamp);
+        switch(ev.type) {
+        case GameWindowEventType::WINDOW_SIZE:
+            setSurface(ev.windowSize.width, ev.windowSize.height, ev.windowSize.width, ev.windowSize.height, pendingSurface.scaleX, pendingSurface.scaleY);
+            break;
+        case GameWindowEventType::SURFACE_CHANGED:
+            setSurface(ev.surface.pixelWidth, ev.surface.pixelHeight, ev.surface.width, ev.surface.height, ev.surface.scaleX, ev.surface.scaleY);
+            break;
+        case GameWindowEventType::MOUSE_BUTTON:
+            onMouseButton(ev.mouseButton.x, ev.mouseButton.y, ev.mouseButton.button, ev.mouseButton.action);
+            break;
+        case GameWindowEventType::MOUSE_POSITION:
+            onMousePosition(ev.mousePosition.x, ev.mousePosition.y);
+            break;
+        case GameWindowEventType::MOUSE_RELATIVE_POSITION:
+            onMouseRelativePosition(ev.mousePosition.x, ev.mousePosition.y);
+            break;
+        case GameWindowEventType::MOUSE_SCROLL:
+            onMouseScroll(ev.mouseScroll.x, ev.mouseScroll.y, ev.mouseScroll.dx, ev.mouseScroll.dy);
+            break;
+        case GameWindowEventType::TOUCH_START:
+            onTouchStart(ev.touch.id, ev.touch.x, ev.touch.y, ev.touch.pressure);
+            break;
+        case GameWindowEventType::TOUCH_UPDATE:
+            onTouchUpdate(ev.touch.id, ev.touch.x, ev.touch.y, ev.touch.pressure);
+            break;
+        case GameWindowEventType::TOUCH_END:
+            onTouchEnd(ev.touch.id, ev.touch.x, ev.touch.y, ev.touch.pressure);
+            break;
+        case GameWindowEventType::TOUCH_FRAME:
+            break;
+        case GameWindowEventType::KEYBOARD:
+            onKeyboard(ev.keyboard.key, ev.keyboard.action, ev.keyboard.mods);
+            break;
+        case GameWindowEventType::KEYBOARD_TEXT:
+            onKeyboardText(dispatchedInjectedEvents.getText(ev));
+            break;
+        case GameWindowEventType::DROP:
+            onDrop(std::string(dispatchedInjectedEvents.getText(ev)));
+            break;
+        case GameWindowEventType::PASTE:
+            onPaste(dispatchedInjectedEvents.getText(ev));
+            break;
+        case GameWindowEventType::GAMEPAD_STATE:
+            onGamepadState(ev.gamepadState.id, ev.gamepadState.connected);
+            break;
+        case GameWindowEventType::GAMEPAD_BUTTON:
+            onGamepadButton(ev.gamepadButton.id, ev.gamepadButton.button, ev.gamepadButton.pressed);
+            break;
+        case GameWindowEventType::GAMEPAD_AXIS:
+            onGamepadAxis(ev.gamepadAxis.id, ev.gamepadAxis.axis, ev.gamepadAxis.value);
+            break;
+        case GameWindowEventType::FOCUS:
+            onFocus(ev.focus.focused);
+            break;
+        case GameWindowEventType::VISIBILITY:
+            onVisibility(ev.visibility.visible);
+            break;
+        case GameWindowEventType::CLOSE:
+            onClose();
+            break;
+        }
+    }
+    setEventTimestamp(0);
+    dispatchedInjectedEvents.clear();
+}
+
+void GameWindow::setInputTraceRecorder(std::shared_ptr<GameWindowInputTraceRecorder> recorder) {
+    // Ends the chunk of the previous recorder
+    if(traceRecorder != nullptr)
+        traceRecorder->endPoll(getTimestamp());
+    traceRecorder = std::move(recorder);
+}
+
+void GameWindow::recordTraceEvent(GameWindowEvent const& ev, std::string_view text) {
+    traceRecorder->record(ev, text);
+}
+
+void GameWindow::endTracePoll() {
+    traceRecorder->endPoll(getTimestamp());
+}
+
+void GameWindow::replayTrace() {
+    uint64_t now = getTimestamp();
+    GameWindowInputTracePlayer::Chunk chunk;
+    while(tracePlayer->nextChunk(now, chunk)) {
+        for(size_t i = 0; i < chunk.eventCount; i++) {
+            GameWindowEvent ev = chunk.events[i];
+            ev.timestamp = tracePlayer->mapTimestamp(ev.timestamp, now);
+            std::string_view text;
+            if(ev.type == GameWindowEventType::KEYBOARD_TEXT || ev.type == GameWindowEventType::DROP || ev.type == GameWindowEventType::PASTE)
+                text = std::string_view(chunk.strings + ev.text.offset, ev.text.length);
+            queueEvent(ev, text);
+        }
+    }
+}
+
+void GameWindow::updateGamepadState(GameWindowEvent const& ev) {
+    // All gamepad records start with the id
+    int id = ev.gamepadState.id;
+    if(id < 0 || id >= MAX_GAMEPADS)
+        return;
+    GamepadState& state = gamepadStates[id];
+    switch(ev.type) {
+    case GameWindowEventType::GAMEPAD_STATE: {
+        uint32_t sequence = state.sequence;
+        state = GamepadState();
+        state.connected = ev.gamepadState.connected;
+        state.sequence = sequence;
+        break;
+    }
+    case GameWindowEventType::GAMEPAD_BUTTON:
+        if(ev.gamepadButton.pressed)
+            state.buttons |= 1u << (int)ev.gamepadButton.button;
+        else
+            state.buttons &= ~(1u << (int)ev.gamepadButton.button);
+        break;
+    case GameWindowEventType::GAMEPAD_AXIS:
+        state.axes[(int)ev.gamepadAxis.axis] = ev.gamepadAxis.value;
+        break;
+    default:
+        return;
+    }
+    state.sequence++;
+    changedGamepads |= 1u << id;
+}
+
+int GameWindow::getTouchSlot(int64_t nativeId, bool assign) {
+    int freeSlot = -1;
+    for(int i = 0; i < MAX_TOUCH_POINTS; i++) {
+        if(!(touchSlots & (1u << i))) {
+            if(freeSlot == -1)
+                freeSlot = i;
+        } else if(touchSlotIds[i] == nativeId) {
+            return i;
+        }
+    }
+    if(!assign || freeSlot == -1)
+        return -1;
+    touchSlots |= 1u << freeSlot;
+    touchSlotIds[freeSlot] = nativeId;
+    return freeSlot;
+}
+
+void GameWindow::updateTouchFrame(GameWindowEvent const& ev) {
+    if(touchFrameDelivered) {
+        // Start the next frame, ended contacts were reported once
+        touchFrameDelivered = false;
+        touchFrame.erase(std::remove_if(touchFrame.begin(), touchFrame.end(), [](TouchPoint const& p) { return p.phase == TouchPhase::END; }), touchFrame.end());
+        for(auto& p : touchFrame)
+            p.phase = TouchPhase::STATIONARY;
+    }
+    TouchPhase phase = ev.type == GameWindowEventType::TOUCH_START ? TouchPhase::START : ev.type == GameWindowEventType::TOUCH_END ? TouchPhase::END : TouchPhase::UPDATE;
+    TouchPoint* point = nullptr;
+    for(auto& p : touchFrame) {
+        // A slot ended in this frame may already be reused
+        if(p.id == ev.touch.id && p.phase != TouchPhase::END) {
+            point = &p;
+            break;
+        }
+    }
+    if(point == nullptr) {
+        if(phase == TouchPhase::END)
+            return;
+        point = &touchFrame.emplace_back();
+        point->id = ev.touch.id;
+        point->phase = TouchPhase::START;
+    } else if(phase == TouchPhase::END || point->phase != TouchPhase::START) {
+        // Contacts starting in this frame are reported as started
+        point->phase = phase;
+    }
+    point->x = ev.touch.x;
+    point->y = ev.touch.y;
+    point->pressure = ev.touch.pressure;
+    point->timestamp = ev.timestamp;
+}
+
+void GameWindow::captureFrame() {
+    // The size of the drawable being presented, the delivered surface lags behind it until the next poll
+    uint64_t size = drawableSize.load(std::memory_order_relaxed);
+    frameCapture->capture((int)(uint32_t)(size >> 32), (int)(uint32_t)size);
+}
+
+void GameWindow::recordFirstContextCurrent() {
+    recordStartupPhase(StartupPhase::FIRST_CONTEXT_CURRENT, getTimestamp());
+}
+
+void GameWindow::recordFirstSwap() {
+    recordStartupPhase(StartupPhase::FIRST_SWAP, getTimestamp());
+}
+
+void GameWindow::paceFrame() {
+    double frameRate = framePacing.targetFrameRate;
+    int divisor = framePacing.refreshDivisor;
+    if(frameRate <= 0.0 && divisor <= 0)
+        divisor = swapIntervalEmulation;
+    if(frameRate <= 0.0 && divisor > 0) {
+        double refreshRate = getDisplayRefreshRate();
+        frameRate = (refreshRate > 0.0 ? refreshRate : 60.0) / divisor;
+    }
+    if(isBackgroundThrottled() && (frameRate <= 0.0 || frameRate > backgroundFrameRate))
+        frameRate = backgroundFrameRate;
+    if(frameRate <= 0.0) {
+        nextFrameDeadline = 0;
+        return;
+    }
+    uint64_t interval = (uint64_t)(1000000000.0 / frameRate);
+    uint64_t now = getTimestamp();
+    // Start over instead of rushing frames after a stall
+    if(nextFrameDeadline == 0 || now > nextFrameDeadline + interval) {
+        nextFrameDeadline = now + interval;
+        return;
+    }
+    if(nextFrameDeadline > now + framePacing.spinThreshold)
+        std::this_thread::sleep_for(std::chrono::nanoseconds(nextFrameDeadline - now - framePacing.spinThreshold));
+    while(getTimestamp() < nextFrameDeadline)
+        std::this_thread::yield();
+#ifdef GAMEWINDOW_METRICS
+    GameWindowMetricsCollector::record(GameWindowMetricsCollector::HistogramId::FRAME_PACING_WAIT, getTimestamp() - now);
+#endif
+    nextFrameDeadline += interval;
+}
+
+// The deadzone filters divide by 1 - deadzone
+static float clampDeadzone(float deadzone) {
+    if(!(deadzone > 0.0f))
+        return 0.0f;
+    return deadzone < 1.0f ? deadzone : std::nextafter(1.0f, 0.0f);
+}
+
+void GameWindow::setGamepadAxisFilter(GamepadAxisFilter const& filter) {
+    std::lock_guard<std::mutex> lock(gamepadAxisFilterLock);
+    gamepadAxisFilter = filter;
+    gamepadAxisFilter.radialDeadzone = clampDeadzone(filter.radialDeadzone);
+    gamepadAxisFilter.axialDeadzone = clampDeadzone(filter.axialDeadzone);
+    gamepadAxisFilterChanged = true;
+}
+
+static float applyAxialDeadzone(float value, float deadzone) {
+    float magnitude = std::fabs(value);
+    if(magnitude <= deadzone)
+        return 0.0f;
+    return std::copysign(std::fmin((magnitude - deadzone) / (1.0f - deadzone), 1.0f), value);
+}
+
+void GameWindow::filterGamepadAxis(int id, GamepadAxisId axis, float val) {
+    if(gamepadAxisFilterChanged.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(gamepadAxisFilterLock);
+        activeGamepadAxisFilter = gamepadAxisFilter;
+        gamepadAxisFilterChanged = false;
+    }
+    GamepadAxisState* state = nullptr;
+    for(auto& s : gamepadAxisStates) {
+        if(s.id == id) {
+            state = &s;
+            break;
+        }
+    }
+    if(state == nullptr) {
+        state = &gamepadAxisStates.emplace_back();
+        state->id = id;
+        for(int i = 0; i < 6; i++)
+            state->raw[i] = state->reported[i] = 0.0f;
+    }
+    int index = (int)axis;
+    state->raw[index] = val;
+
+    // Sticks are filtered as a pair, a change of one axis may move the other one out of the deadzone
+    int first = index, last = index;
+    float filtered[6];
+    if(axis == GamepadAxisId::LEFT_TRIGGER || axis == GamepadAxisId::RIGHT_TRIGGER) {
+        filtered[index] = applyAxialDeadzone(val, activeGamepadAxisFilter.axialDeadzone);
+    } else {
+        first = index & ~1;
+        last = first + 1;
+        float x = state->raw[first], y = state->raw[last];
+        float magnitude = std::sqrt(x * x + y * y);
+        if(magnitude <= activeGamepadAxisFilter.radialDeadzone) {
+            x = y = 0.0f;
+        } else if(activeGamepadAxisFilter.radialDeadzone > 0.0f) {
+            float scale = (std::fmin(magnitude, 1.0f) - activeGamepadAxisFilter.radialDeadzone) / (1.0f - activeGamepadAxisFilter.radialDeadzone) / magnitude;
+            x *= scale;
+            y *= scale;
+        }
+        filtered[first] = applyAxialDeadzone(x, activeGamepadAxisFilter.axialDeadzone);
+        filtered[last] = applyAxialDeadzone(y, activeGamepadAxisFilter.axialDeadzone);
+    }
+
+    for(int i = first; i <= last; i++) {
+        float value = filtered[i];
+        float previous = state->reported[i];
+        if(value == previous)
+            continue;
+        bool limit = value == 0.0f || std::fabs(value) >= 1.0f;
+        if(!limit && std::fabs(value - previous) < activeGamepadAxisFilter.changeThreshold) {
+            GameWindowMetricsCollector::add(GameWindowMetricsCollector::CounterId::FILTERED_EVENTS);
+            continue;
+        }
+        state->reported[i] = value;
+        auto ev = makeEvent(GameWindowEventType::GAMEPAD_AXIS);
+        ev.gamepadAxis = {id, (GamepadAxisId)i, value};
+        queueEvent(ev);
+    }
+}
@@ -0,0 +1,295 @@
+#include <game_window_frame_capture.h>
+#include <game_window_manager.h>
+#include <cstring>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+
+// Only the few enums used here, the window context may be any of OpenGL 2.0 - 4.6 or OpenGL ES 2.0 - 3.2
+#define GL_UNSIGNED_BYTE 0x1401
+#define GL_RGBA 0x1908
+#define GL_BGRA 0x80E1
+#define GL_RGBA8 0x8058
+#define GL_LINEAR 0x2601
+#define GL_COLOR_BUFFER_BIT 0x00004000
+#define GL_VERSION 0x1F02
+#define GL_EXTENSIONS 0x1F03
+#define GL_PACK_ALIGNMENT 0x0D05
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#define GL_PIXEL_PACK_BUFFER_BINDING 0x88ED
+#define GL_STREAM_READ 0x88E1
+#define GL_MAP_READ_BIT 0x0001
+#define GL_FRAMEBUFFER 0x8D40
+#define GL_READ_FRAMEBUFFER 0x8CA8
+#define GL_DRAW_FRAMEBUFFER 0x8CA9
+#define GL_FRAMEBUFFER_BINDING 0x8CA6
+#define GL_READ_FRAMEBUFFER_BINDING 0x8CAA
+#define GL_DRAW_FRAMEBUFFER_BINDING 0x8CA6
+#define GL_RENDERBUFFER 0x8D41
+#define GL_RENDERBUFFER_BINDING 0x8CA7
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+
+typedef const unsigned char* (*GetStringFunc)(unsigned int name);
+typedef void (*GetIntegervFunc)(unsigned int pname, int* data);
+typedef void (*PixelStoreiFunc)(unsigned int pname, int param);
+typedef void (*ReadPixelsFunc)(int x, int y, int width, int height, unsigned int format, unsigned int type, void* pixels);
+typedef void (*GenFunc)(int n, unsigned int* ids);
+typedef void (*DeleteFunc)(int n, const unsigned int* ids);
+typedef void (*BindFunc)(unsigned int target, unsigned int id);
+typedef void (*BufferDataFunc)(unsigned int target, ptrdiff_t size, const void* data, unsigned int usage);
+typedef void* (*MapBufferRangeFunc)(unsigned int target, ptrdiff_t offset, ptrdiff_t length, unsigned int access);
+typedef unsigned char (*UnmapBufferFunc)(unsigned int target);
+typedef void (*RenderbufferStorageFunc)(unsigned int target, unsigned int format, int width, int height);
+typedef void (*FramebufferRenderbufferFunc)(unsigned int target, unsigned int attachment, unsigned int renderbufferTarget, unsigned int renderbuffer);
+typedef void (*BlitFramebufferFunc)(int srcX0, int srcY0, int srcX1, int srcY1, int dstX0, int dstY0, int dstX1, int dstY1, unsigned int mask, unsigned int filter);
+
+static struct {
+    std::once_flag loaded;
+    GetStringFunc getString = nullptr;
+    GetIntegervFunc getIntegerv = nullptr;
+    PixelStoreiFunc pixelStorei = nullptr;
+    ReadPixelsFunc readPixels = nullptr;
+    BindFunc bindFramebuffer = nullptr;
+    // Pixel buffers and the downscale, only used if all of them are available
+    GenFunc genBuffers = nullptr;
+    DeleteFunc deleteBuffers = nullptr;
+    BindFunc bindBuffer = nullptr;
+    BufferDataFunc bufferData = nullptr;
+    MapBufferRangeFunc mapBufferRange = nullptr;
+    UnmapBufferFunc unmapBuffer = nullptr;
+    GenFunc genFramebuffers = nullptr;
+    DeleteFunc deleteFramebuffers = nullptr;
+    GenFunc genRenderbuffers = nullptr;
+    DeleteFunc deleteRenderbuffers = nullptr;
+    BindFunc bindRenderbuffer = nullptr;
+    RenderbufferStorageFunc renderbufferStorage = nullptr;
+    FramebufferRenderbufferFunc framebufferRenderbuffer = nullptr;
+    BlitFramebufferFunc blitFramebuffer = nullptr;
+    bool buffers = false;
+} gl;
+
+static void loadCaptureFunctions() {
+    std::call_once(gl.loaded, []() {
+        auto getProcAddr = GameWindowManager::getManager()->getProcAddrFunc();
+        gl.getString = (GetStringFunc)getProcAddr("glGetString");
+        gl.getIntegerv = (GetIntegervFunc)getProcAddr("glGetIntegerv");
+        gl.pixelStorei = (PixelStoreiFunc)getProcAddr("glPixelStorei");
+        gl.readPixels = (ReadPixelsFunc)getProcAddr("glReadPixels");
+        gl.bindFramebuffer = (BindFunc)getProcAddr("glBindFramebuffer");
+        gl.genBuffers = (GenFunc)getProcAddr("glGenBuffers");
+        gl.deleteBuffers = (DeleteFunc)getProcAddr("glDeleteBuffers");
+        gl.bindBuffer = (BindFunc)getProcAddr("glBindBuffer");
+        gl.bufferData = (BufferDataFunc)getProcAddr("glBufferData");
+        gl.mapBufferRange = (MapBufferRangeFunc)getProcAddr("glMapBufferRange");
+        gl.unmapBuffer = (UnmapBufferFunc)getProcAddr("glUnmapBuffer");
+        gl.genFramebuffers = (GenFunc)getProcAddr("glGenFramebuffers");
+        gl.deleteFramebuffers = (DeleteFunc)getProcAddr("glDeleteFramebuffers");
+        gl.genRenderbuffers = (GenFunc)getProcAddr("glGenRenderbuffers");
+        gl.deleteRenderbuffers = (DeleteFunc)getProcAddr("glDeleteRenderbuffers");
+        gl.bindRenderbuffer = (BindFunc)getProcAddr("glBindRenderbuffer");
+        gl.renderbufferStorage = (RenderbufferStorageFunc)getProcAddr("glRenderbufferStorage");
+        gl.framebufferRenderbuffer = (FramebufferRenderbufferFunc)getProcAddr("glFramebufferRenderbuffer");
+        gl.blitFramebuffer = (BlitFramebufferFunc)getProcAddr("glBlitFramebuffer");
+        gl.buffers = gl.bindFramebuffer != nullptr && gl.genBuffers != nullptr && gl.deleteBuffers != nullptr && gl.bindBuffer != nullptr &&
+                gl.bufferData != nullptr && gl.mapBufferRange != nullptr && gl.unmapBuffer != nullptr &&
+                gl.genFramebuffers != nullptr && gl.deleteFramebuffers != nullptr && gl.genRenderbuffers != nullptr &&
+                gl.deleteRenderbuffers != nullptr && gl.bindRenderbuffer != nullptr && gl.renderbufferStorage != nullptr &&
+                gl.framebufferRenderbuffer != nullptr && gl.blitFramebuffer != nullptr;
+    });
+}
+
+// Pointers are loaded once per process, whether the current context supports them is a matter of its version
+static bool getContextVersion(bool& es, int& major, int& minor) {
+    auto version = (const char*)gl.getString(GL_VERSION);
+    if (version == nullptr)
+        return false;
+    es = strncmp(version, "OpenGL ES", 9) == 0;
+    const char* number = version;
+    while (*number != '\0' && (*number < '0' || *number > '9'))
+        number++;
+    major = atoi(number);
+    const char* dot = strchr(number, '.');
+    minor = dot != nullptr ? atoi(dot + 1) : 0;
+    return true;
+}
+
+GameWindowFrameCapture::GameWindowFrameCapture(Options options, FrameCallback callback) : options(options), callback(std::move(callback)) {
+    loadCaptureFunctions();
+    if (gl.getString == nullptr || gl.getIntegerv == nullptr || gl.pixelStorei == nullptr || gl.readPixels == nullptr)
+        throw std::runtime_error("The context has no glReadPixels");
+    bool es = false;
+    int major = 0, minor = 0;
+    if (!getContextVersion(es, major, minor))
+        throw std::runtime_error("No context is current");
+    asynchronous = gl.buffers && major >= 3;
+    // Pixel buffers are core since OpenGL 2.1 and OpenGL ES 3.0, the synchronous read must not go into one the application bound
+    packBuffers = gl.bindBuffer != nullptr && (es ? major >= 3 : major > 2 || (major == 2 && minor >= 1));
+    if (options.format == PixelFormat::BGRA && es) {
+        // Desktop OpenGL always reads BGRA, OpenGL ES only with the extension
+        auto extensions = (const char*)gl.getString(GL_EXTENSIONS);
+        swizzle = extensions == nullptr || strstr(extensions, "GL_EXT_read_format_bgra") == nullptr;
+    }
+    if (this->options.ringSize < 2)
+        this->options.ringSize = 2;
+    if (asynchronous) {
+        slots.resize(this->options.ringSize);
+        for (auto& slot : slots)
+            gl.genBuffers(1, &slot.buffer);
+    }
+}
+
+GameWindowFrameCapture::~GameWindowFrameCapture() {
+    for (auto& slot : slots) {
+        slot.fence = GameWindowFence();
+        gl.deleteBuffers(1, &slot.buffer);
+    }
+    if (framebuffer != 0)
+        gl.deleteFramebuffers(1, &framebuffer);
+    if (renderbuffer != 0)
+        gl.deleteRenderbuffers(1, &renderbuffer);
+}
+
+void GameWindowFrameCapture::getFrameSize(int framebufferWidth, int framebufferHeight, int& width, int& height) const {
+    width = framebufferWidth;
+    height = framebufferHeight;
+    if (asynchronous && options.width > 0 && options.height > 0) {
+        width = options.width;
+        height = options.height;
+    }
+}
+
+void GameWindowFrameCapture::readPixels(int width, int height, void* pixels) {
+    int alignment;
+    gl.getIntegerv(GL_PACK_ALIGNMENT, &alignment);
+    gl.pixelStorei(GL_PACK_ALIGNMENT, 4);
+    gl.readPixels(0, 0, width, height, options.format == PixelFormat::BGRA && !swizzle ? GL_BGRA : GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    gl.pixelStorei(GL_PACK_ALIGNMENT, alignment);
+}
+
+void GameWindowFrameCapture::deliver(const uint8_t* pixels, int width, int height, uint64_t timestamp, uint64_t index) {
+    size_t stride = (size_t)width * 4;
+    if (swizzle) {
+        scratch.resize(stride * height);
+        for (size_t i = 0; i < scratch.size(); i += 4) {
+            scratch[i] = pixels[i + 2];
+            scratch[i + 1] = pixels[i + 1];
+            scratch[i + 2] = pixels[i];
+            scratch[i + 3] = pixels[i + 3];
+        }
+        pixels = scratch.data();
+    }
+    Frame frame = {pixels, width, height, stride, options.format, timestamp, index};
+    callback(frame);
+}
+
+void GameWindowFrameCapture::deliver(Slot& slot) {
+    slot.pending = false;
+    slot.fence = GameWindowFence();
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    auto pixels = (const uint8_t*)gl.mapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (ptrdiff_t)slot.size, GL_MAP_READ_BIT);
+    if (pixels != nullptr) {
+        // swizzle copies the pixels out, otherwise the callback reads straight from the mapping
+        deliver(pixels, slot.width, slot.height, slot.timestamp, slot.index);
+        gl.unmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+        droppedFrames++;
+    }
+}
+
+void GameWindowFrameCapture::flush(bool wait) {
+    if (!asynchronous)
+        return;
+    int packBuffer;
+    gl.getIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &packBuffer);
+    // In order of capture, starting with the oldest frame
+    for (size_t i = 0; i < slots.size(); i++) {
+        auto& slot = slots[(nextSlot + i) % slots.size()];
+        if (!slot.pending)
+            continue;
+        if (!(wait ? slot.fence.wait(UINT64_MAX) : slot.fence.isSignaled()))
+            break;
+        deliver(slot);
+    }
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+}
+
+void GameWindowFrameCapture::capture(int framebufferWidth, int framebufferHeight) {
+    if (framebufferWidth <= 0 || framebufferHeight <= 0)
+        return;
+    int width, height;
+    getFrameSize(framebufferWidth, framebufferHeight, width, height);
+    uint64_t timestamp = GameWindow::getTimestamp();
+    uint64_t index = frameIndex++;
+
+    if (!asynchronous) {
+        int boundFramebuffer, packBuffer = 0;
+        gl.getIntegerv(GL_FRAMEBUFFER_BINDING, &boundFramebuffer);
+        if (gl.bindFramebuffer != nullptr)
+            gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (packBuffers) {
+            gl.getIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &packBuffer);
+            gl.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+        readback.resize((size_t)width * height * 4);
+        readPixels(width, height, readback.data());
+        if (packBuffers)
+            gl.bindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+        if (gl.bindFramebuffer != nullptr)
+            gl.bindFramebuffer(GL_FRAMEBUFFER, boundFramebuffer);
+        deliver(readback.data(), width, height, timestamp, index);
+        return;
+    }
+
+    flush(false);
+    auto& slot = slots[nextSlot];
+    if (slot.pending) {
+        // Every buffer is in flight, waiting would stall the render thread
+        droppedFrames++;
+        return;
+    }
+
+    int packBuffer, readFramebuffer, drawFramebuffer, boundRenderbuffer;
+    gl.getIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &packBuffer);
+    gl.getIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer);
+    gl.getIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFramebuffer);
+    gl.bindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    if (width != framebufferWidth || height != framebufferHeight) {
+        if (framebuffer == 0) {
+            gl.genFramebuffers(1, &framebuffer);
+            gl.genRenderbuffers(1, &renderbuffer);
+        }
+        if (renderbufferWidth != width || renderbufferHeight != height) {
+            gl.getIntegerv(GL_RENDERBUFFER_BINDING, &boundRenderbuffer);
+            gl.bindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+            gl.renderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+            gl.bindRenderbuffer(GL_RENDERBUFFER, boundRenderbuffer);
+            gl.bindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+            gl.framebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+            renderbufferWidth = width;
+            renderbufferHeight = height;
+        }
+        gl.bindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+        gl.blitFramebuffer(0, 0, framebufferWidth, framebufferHeight, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        gl.bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    }
+
+    size_t size = (size_t)width * height * 4;
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.size != size) {
+        gl.bufferData(GL_PIXEL_PACK_BUFFER, (ptrdiff_t)size, nullptr, GL_STREAM_READ);
+        slot.size = size;
+    }
+    // Only queues the copy, the pixels are read once the fence signaled
+    readPixels(width, height, nullptr);
+    slot.width = width;
+    slot.height = height;
+    slot.timestamp = timestamp;
+    slot.index = index;
+    slot.fence = GameWindowFence::create();
+    slot.pending = true;
+    nextSlot = (nextSlot + 1) % slots.size();
+
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER, packBuffer);
+    gl.bindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+    gl.bindFramebuffer(GL_DRAW_FRAMEBUFFER, drawFramebuffer);
+}
@@ -0,0 +1,150 @@
+#include <game_window_input_thread.h>
+#include "spsc_ring_buffer.h"
+#include "game_window_metrics_collector.h"
+
+struct GameWindowInputThread::Queue {
+    SpscRingBuffer<GameWindowEvent> events;
+    // Text of KEYBOARD_TEXT, DROP and PASTE events, pushed before the event itself
+    SpscRingBuffer<char> text;
+    // Only used by the consuming thread
+    EventBuffer drained;
+    std::string textScratch;
+
+    explicit Queue(size_t capacity) : events(capacity), text(capacity * 4) {}
+};
+
+static bool hasText(GameWindowEventType type) {
+    return type == GameWindowEventType::KEYBOARD_TEXT || type == GameWindowEventType::DROP || type == GameWindowEventType::PASTE;
+}
+
+GameWindowInputThread::GameWindowInputThread(std::shared_ptr<GameWindow> window, size_t capacity) : window(std::move(window)), queue(new Queue(capacity)) {
+    captured.reserve(256, 1024);
+    backlog.reserve(256, 1024);
+    retried.reserve(256, 1024);
+    queue->drained.reserve(capacity, 1024);
+}
+
+GameWindowInputThread::~GameWindowInputThread() {
+    stop();
+}
+
+void GameWindowInputThread::start() {
+    if (running.exchange(true))
+        return;
+    thread = std::thread([this]() {
+        while (running) {
+            pumpEvents();
+            std::this_thread::sleep_for(std::chrono::microseconds(pollIntervalUs.load()));
+        }
+    });
+}
+
+void GameWindowInputThread::run() {
+    if (running.exchange(true))
+        return;
+    while (running) {
+        pumpEvents();
+        std::this_thread::sleep_for(std::chrono::microseconds(pollIntervalUs.load()));
+    }
+}
+
+void GameWindowInputThread::stop() {
+    running = false;
+    if (thread.joinable() && thread.get_id() != std::this_thread::get_id())
+        thread.join();
+}
+
+void GameWindowInputThread::pumpEvents() {
+    captured.clear();
+    window->captureBuffer = &captured;
+    window->pollEvents();
+    window->captureBuffer = nullptr;
+
+    // The backlog goes first to keep the order
+    std::swap(backlog, retried);
+    backlog.clear();
+    for (auto& ev : retried)
+        forwardEvent(ev, retried.getText(ev));
+    for (auto& ev : captured)
+        forwardEvent(ev, captured.getText(ev));
+}
+
+void GameWindowInputThread::forwardEvent(GameWindowEvent const& ev, std::string_view text) {
+    if (!backlog.empty()) {
+        if (backlog.size() < queue->events.capacity())
+            backlog.push(ev, text);
+        else
+            dropEvent();
+        return;
+    }
+    if (ev.type == GameWindowEventType::PASTE) {
+        // Pieces of a quarter of the text ring, a paste larger than the ring is pushed over several pumps
+        size_t maxLength = queue->text.capacity() / 4;
+        do {
+            size_t length = GameWindow::getUtf8Boundary(text, maxLength);
+            if (length == 0)
+                length = maxLength;
+            if (!pushTextEvent(ev, text.substr(0, length))) {
+                backlog.push(ev, text);
+                return;
+            }
+            text.remove_prefix(length);
+        } while (!text.empty());
+    } else if (hasText(ev.type)) {
+        if (!pushTextEvent(ev, text))
+            dropEvent();
+    } else if (!queue->events.push(ev)) {
+        dropEvent();
+    }
+}
+
+bool GameWindowInputThread::pushTextEvent(GameWindowEvent const& ev, std::string_view text) {
+    // Both rings have a single consumer, so free space only grows until the event is pushed
+    if (queue->events.freeSpace() == 0 || !queue->text.push(text.data(), text.size()))
+        return false;
+    GameWindowEvent queued = ev;
+    queued.text.offset = 0;
+    queued.text.length = (uint32_t)text.size();
+    queue->events.push(queued);
+    return true;
+}
+
+void GameWindowInputThread::dropEvent() {
+    droppedEvents++;
+    GameWindowMetricsCollector::add(GameWindowMetricsCollector::CounterId::DROPPED_EVENTS);
+}
+
+void GameWindowInputThread::drainQueue() {
+    // The pumping thread doesn't wait for the frame, see GameWindow::beginPollEvents
+    if (window->framePacing.lateInputSampling)
+        window->paceFrame();
+    auto& buffer = queue->drained;
+    buffer.clear();
+    GameWindowEvent ev;
+    while (queue->events.pop(ev)) {
+        if (hasText(ev.type)) {
+            queue->textScratch.clear();
+            queue->text.pop(ev.text.length, [this](char c) { queue->textScratch.push_back(c); });
+            buffer.push(ev, queue->textScratch);
+        } else {
+            buffer.push(ev, {});
+        }
+    }
+    // After the events, so the samples of all drained events were handed over
+    window->takeCapturedMouseRelativeHistory();
+}
+
+void GameWindowInputThread::pollEvents(EventBuffer& buffer) {
+    drainQueue();
+    buffer.clear();
+    // Goes through the window so the frame latency and last event timestamp stay up to date
+    window->eventBuffer = &buffer;
+    window->dispatchEvents(queue->drained);
+    window->eventBuffer = nullptr;
+}
+
+size_t GameWindowInputThread::dispatchEvents() {
+    drainQueue();
+    window->dispatchEvents(queue->drained);
+    return queue->drained.size();
+}
@@ -0,0 +1,176 @@
+#include <game_window_input_trace.h>
+#include "mapped_file.h"
+#include <cstring>
+#include <stdexcept>
+
+static const char INPUT_TRACE_MAGIC[4] = {'G', 'W', 'I', 'T'};
+static const uint32_t INPUT_TRACE_VERSION = 1;
+
+struct InputTraceHeader {
+    char magic[4];
+    uint32_t version;
+    // sizeof(GameWindowEvent) of the recording build
+    uint32_t eventSize;
+    uint32_t reserved;
+};
+
+struct InputTraceChunkHeader {
+    // Time of the poll, see GameWindow::getTimestamp
+    uint64_t timestamp;
+    uint32_t eventCount;
+    uint32_t stringBytes;
+};
+
+// Records are used in place from the mapping
+static_assert(sizeof(InputTraceHeader) % 8 == 0 && sizeof(InputTraceChunkHeader) % 8 == 0 && sizeof(GameWindowEvent) % 8 == 0, "input trace records must stay 8 byte aligned");
+
+static size_t alignTraceSize(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+GameWindowInputTraceRecorder::GameWindowInputTraceRecorder(std::string const& path) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        throw std::runtime_error("Failed to create the input trace " + path);
+    InputTraceHeader header = {};
+    memcpy(header.magic, INPUT_TRACE_MAGIC, sizeof(header.magic));
+    header.version = INPUT_TRACE_VERSION;
+    header.eventSize = sizeof(GameWindowEvent);
+    if (!reserve(sizeof(header))) {
+        ::close(fd);
+        throw std::runtime_error("Failed to map the input trace " + path);
+    }
+    memcpy(mapping, &header, sizeof(header));
+    size = sizeof(header);
+    pending.reserve(256, 1024);
+}
+
+GameWindowInputTraceRecorder::~GameWindowInputTraceRecorder() {
+    endPoll(GameWindow::getTimestamp());
+    if (mapping != nullptr)
+        munmap(mapping, capacity);
+    // Drop the unused tail of the last growth step
+    if (ftruncate(fd, (off_t)size) != 0)
+        perror("Failed to truncate the input trace");
+    ::close(fd);
+}
+
+bool GameWindowInputTraceRecorder::reserve(size_t bytes) {
+    if (size + bytes <= capacity)
+        return true;
+    size_t newCapacity = capacity > 0 ? capacity * 2 : 1024 * 1024;
+    while (newCapacity < size + bytes)
+        newCapacity *= 2;
+    if (mapping != nullptr)
+        munmap(mapping, capacity);
+    mapping = nullptr;
+    capacity = 0;
+    if (ftruncate(fd, (off_t)newCapacity) != 0)
+        return false;
+    void* ptr = mmap(nullptr, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED)
+        return false;
+    mapping = (char*)ptr;
+    capacity = newCapacity;
+    return true;
+}
+
+void GameWindowInputTraceRecorder::record(GameWindowEvent const& ev, std::string_view text) {
+    pending.push(ev, text);
+}
+
+void GameWindowInputTraceRecorder::endPoll(uint64_t timestamp) {
+    if (pending.empty())
+        return;
+    std::string_view strings = pending.getStrings();
+    InputTraceChunkHeader header = {timestamp, (uint32_t)pending.size(), (uint32_t)strings.size()};
+    size_t eventBytes = pending.size() * sizeof(GameWindowEvent);
+    size_t chunkSize = sizeof(header) + eventBytes + alignTraceSize(strings.size());
+    // A failed growth drops the chunk, the trace stays valid up to the previous one
+    if (reserve(chunkSize)) {
+        char* out = mapping + size;
+        // The header goes last, so a partially written chunk is never read
+        memcpy(out + sizeof(header), pending.begin(), eventBytes);
+        memcpy(out + sizeof(header) + eventBytes, strings.data(), strings.size());
+        memset(out + sizeof(header) + eventBytes + strings.size(), 0, alignTraceSize(strings.size()) - strings.size());
+        memcpy(out, &header, sizeof(header));
+        size += chunkSize;
+    }
+    pending.clear();
+}
+
+struct GameWindowInputTracePlayer::Trace {
+    MappedFile file;
+    uint64_t lastChunkNow = 0;
+
+    // Returns false at the end of the trace or at a truncated chunk
+    bool getChunk(size_t offset, InputTraceChunkHeader& header, size_t& chunkSize) const {
+        if (offset + sizeof(header) > file.size())
+            return false;
+        memcpy(&header, file.data() + offset, sizeof(header));
+        if (header.eventCount == 0)
+            return false;
+        chunkSize = sizeof(header) + (size_t)header.eventCount * sizeof(GameWindowEvent) + alignTraceSize(header.stringBytes);
+        return chunkSize <= file.size() - offset;
+    }
+};
+
+GameWindowInputTracePlayer::GameWindowInputTracePlayer(std::string const& path, Speed speed) : trace(new Trace()), speed(speed) {
+    if (!trace->file.open(path))
+        throw std::runtime_error("Failed to open the input trace " + path);
+    InputTraceHeader header;
+    if (trace->file.size() < sizeof(header))
+        throw std::runtime_error("Invalid input trace " + path);
+    memcpy(&header, trace->file.data(), sizeof(header));
+    if (memcmp(header.magic, INPUT_TRACE_MAGIC, sizeof(header.magic)) != 0 || header.version != INPUT_TRACE_VERSION)
+        throw std::runtime_error("Invalid input trace " + path);
+    if (header.eventSize != sizeof(GameWindowEvent))
+        throw std::runtime_error("The input trace " + path + " was recorded by an incompatible build");
+    offset = sizeof(header);
+}
+
+GameWindowInputTracePlayer::~GameWindowInputTracePlayer() {
+}
+
+bool GameWindowInputTracePlayer::nextChunk(uint64_t now, Chunk& chunk) {
+    InputTraceChunkHeader header;
+    size_t chunkSize;
+    if (!trace->getChunk(offset, header, chunkSize))
+        return false;
+    if (replayStartTimestamp == 0) {
+        replayStartTimestamp = now;
+        firstPollTimestamp = header.timestamp;
+    }
+    if (speed == Speed::MAXIMUM) {
+        if (trace->lastChunkNow == now)
+            return false;
+        trace->lastChunkNow = now;
+    } else if (header.timestamp - firstPollTimestamp > now - replayStartTimestamp) {
+        return false;
+    }
+    const char* data = trace->file.data() + offset;
+    chunk.events = (const GameWindowEvent*)(data + sizeof(header));
+    chunk.eventCount = header.eventCount;
+    chunk.strings = data + sizeof(header) + (size_t)header.eventCount * sizeof(GameWindowEvent);
+    offset += chunkSize;
+    return true;
+}
+
+uint64_t GameWindowInputTracePlayer::mapTimestamp(uint64_t timestamp, uint64_t now) const {
+    if (speed == Speed::MAXIMUM)
+        return now;
+    // Events happen before their poll, the modular arithmetic keeps them before it
+    return replayStartTimestamp + (timestamp - firstPollTimestamp);
+}
+
+bool GameWindowInputTracePlayer::isFinished() const {
+    InputTraceChunkHeader header;
+    size_t chunkSize;
+    return !trace->getChunk(offset, header, chunkSize);
+}
+
+void GameWindowInputTracePlayer::rewind() {
+    offset = sizeof(InputTraceHeader);
+    firstPollTimestamp = replayStartTimestamp = 0;
+    trace->lastChunkNow = 0;
+}
@@ -1,9 +1,42 @@
 #include <game_window_manager.h>
+#include "startup_timings.h"
+#include <atomic>
 
 std::shared_ptr<GameWindowManager> GameWindowManager::instance;
 
+static std::atomic<uint64_t> startupPhases[(int)StartupPhase::COUNT];
+
+void recordStartupPhase(StartupPhase phase, uint64_t timestamp) {
+    uint64_t expected = 0;
+    startupPhases[(int)phase].compare_exchange_strong(expected, timestamp, std::memory_order_relaxed);
+}
+
+void recordWindowCreated(uint64_t creationStart) {
+    // Both or neither, a window created concurrently must not contribute only one of them
+    uint64_t expected = 0;
+    if (startupPhases[(int)StartupPhase::FIRST_WINDOW_CREATION_START].compare_exchange_strong(expected, creationStart, std::memory_order_relaxed))
+        startupPhases[(int)StartupPhase::FIRST_WINDOW_CREATED].store(GameWindow::getTimestamp(), std::memory_order_relaxed);
+}
+
 std::shared_ptr<GameWindowManager> GameWindowManager::getManager() {
-    if (!instance)
+    if (!instance) {
+        recordStartupPhase(StartupPhase::MANAGER_CREATION_START, GameWindow::getTimestamp());
         instance = createManager();
+        recordStartupPhase(StartupPhase::MANAGER_CREATED, GameWindow::getTimestamp());
+    }
     return instance;
-}
\ No newline at end of file
+}
+
+GameWindowManager::StartupTimings GameWindowManager::getStartupTimings() {
+    auto get = [](StartupPhase phase) { return startupPhases[(int)phase].load(std::memory_order_relaxed); };
+    StartupTimings timings;
+    timings.managerCreationStart = get(StartupPhase::MANAGER_CREATION_START);
+    timings.managerCreated = get(StartupPhase::MANAGER_CREATED);
+    timings.backendProbeStart = get(StartupPhase::BACKEND_PROBE_START);
+    timings.backendProbed = get(StartupPhase::BACKEND_PROBED);
+    timings.firstWindowCreationStart = get(StartupPhase::FIRST_WINDOW_CREATION_START);
+    timings.firstWindowCreated = get(StartupPhase::FIRST_WINDOW_CREATED);
+    timings.firstContextCurrent = get(StartupPhase::FIRST_CONTEXT_CURRENT);
+    timings.firstSwap = get(StartupPhase::FIRST_SWAP);
+    return timings;
+}
@@ -0,0 +1,111 @@
+#include "game_window_metrics_collector.h"
+#include <game_window_manager.h>
+
+#ifdef GAMEWINDOW_METRICS
+GameWindowMetricsCollector::Histogram GameWindowMetricsCollector::histograms[(int)HistogramId::COUNT];
+std::atomic<uint64_t> GameWindowMetricsCollector::counters[(int)CounterId::COUNT];
+std::atomic<uint64_t> GameWindowMetricsCollector::events[GameWindowMetrics::EVENT_TYPE_COUNT];
+
+void GameWindowMetricsCollector::getSnapshot(GameWindowMetrics& metrics) {
+    metrics.enabled = true;
+    // Each value is read on its own, a snapshot taken while recording may be off by the values in flight
+    for (int i = 0; i < (int)HistogramId::COUNT; i++) {
+        auto& h = histograms[i];
+        auto& out = metrics.histograms[i];
+        out.count = h.count.load(std::memory_order_relaxed);
+        out.sum = h.sum.load(std::memory_order_relaxed);
+        out.max = h.max.load(std::memory_order_relaxed);
+        for (int j = 0; j < GameWindowMetrics::HISTOGRAM_BUCKETS; j++)
+            out.buckets[j] = h.buckets[j].load(std::memory_order_relaxed);
+    }
+    for (int i = 0; i < (int)CounterId::COUNT; i++)
+        metrics.counters[i] = counters[i].load(std::memory_order_relaxed);
+    for (int i = 0; i < GameWindowMetrics::EVENT_TYPE_COUNT; i++)
+        metrics.events[i] = events[i].load(std::memory_order_relaxed);
+}
+#endif
+
+GameWindowMetrics GameWindowManager::getMetricsSnapshot() const {
+    GameWindowMetrics metrics;
+    GameWindowMetricsCollector::getSnapshot(metrics);
+    return metrics;
+}
+
+const char* GameWindowMetrics::getName(HistogramId id) {
+    switch (id) {
+    case HistogramId::POLL_DURATION:
+        return "poll_duration_ns";
+    case HistogramId::EVENTS_PER_POLL:
+        return "events_per_poll";
+    case HistogramId::SWAP_DURATION:
+        return "swap_duration_ns";
+    case HistogramId::FRAME_PACING_WAIT:
+        return "frame_pacing_wait_ns";
+    case HistogramId::X11_LOCK_WAIT:
+        return "x11_lock_wait_ns";
+    case HistogramId::GAMEPAD_POLL_DURATION:
+        return "gamepad_poll_duration_ns";
+    default:
+        return nullptr;
+    }
+}
+
+const char* GameWindowMetrics::getName(CounterId id) {
+    switch (id) {
+    case CounterId::COALESCED_EVENTS:
+        return "coalesced_events";
+    case CounterId::FILTERED_EVENTS:
+        return "filtered_events";
+    case CounterId::DROPPED_EVENTS:
+        return "dropped_events";
+    default:
+        return nullptr;
+    }
+}
+
+const char* GameWindowMetrics::getName(GameWindowEventType type) {
+    switch (type) {
+    case GameWindowEventType::WINDOW_SIZE:
+        return "window_size";
+    case GameWindowEventType::SURFACE_CHANGED:
+        return "surface_changed";
+    case GameWindowEventType::MOUSE_BUTTON:
+        return "mouse_button";
+    case GameWindowEventType::MOUSE_POSITION:
+        return "mouse_position";
+    case GameWindowEventType::MOUSE_RELATIVE_POSITION:
+        return "mouse_relative_position";
+    case GameWindowEventType::MOUSE_SCROLL:
+        return "mouse_scroll";
+    case GameWindowEventType::TOUCH_START:
+        return "touch_start";
+    case GameWindowEventType::TOUCH_UPDATE:
+        return "touch_update";
+    case GameWindowEventType::TOUCH_END:
+        return "touch_end";
+    case GameWindowEventType::TOUCH_FRAME:
+        return "touch_frame";
+    case GameWindowEventType::KEYBOARD:
+        return "keyboard";
+    case GameWindowEventType::KEYBOARD_TEXT:
+        return "keyboard_text";
+    case GameWindowEventType::DROP:
+        return "drop";
+    case GameWindowEventType::PASTE:
+        return "paste";
+    case GameWindowEventType::GAMEPAD_STATE:
+        return "gamepad_state";
+    case GameWindowEventType::GAMEPAD_BUTTON:
+        return "gamepad_button";
+    case GameWindowEventType::GAMEPAD_AXIS:
+        return "gamepad_axis";
+    case GameWindowEventType::FOCUS:
+        return "focus";
+    case GameWindowEventType::VISIBILITY:
+        return "visibility";
+    case GameWindowEventType::CLOSE:
+        return "close";
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <game_window_metrics.h>
+#include <game_window.h>
+#include <atomic>
+
+// Records into the process wide metrics, every call compiles to nothing without GAMEWINDOW_METRICS
+// Lock free, may be called from any thread
+class GameWindowMetricsCollector {
+public:
+    using HistogramId = GameWindowMetrics::HistogramId;
+    using CounterId = GameWindowMetrics::CounterId;
+
+#ifdef GAMEWINDOW_METRICS
+private:
+    struct Histogram {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+        std::atomic<uint64_t> buckets[GameWindowMetrics::HISTOGRAM_BUCKETS];
+    };
+
+    static Histogram histograms[(int)HistogramId::COUNT];
+    static std::atomic<uint64_t> counters[(int)CounterId::COUNT];
+    static std::atomic<uint64_t> events[GameWindowMetrics::EVENT_TYPE_COUNT];
+
+    static int getBucket(uint64_t value) {
+        int bucket = value == 0 ? 0 : 64 - __builtin_clzll(value);
+        return bucket < GameWindowMetrics::HISTOGRAM_BUCKETS ? bucket : GameWindowMetrics::HISTOGRAM_BUCKETS - 1;
+    }
+
+public:
+    static constexpr bool enabled = true;
+
+    static void record(HistogramId id, uint64_t value) {
+        auto& h = histograms[(int)id];
+        h.count.fetch_add(1, std::memory_order_relaxed);
+        h.sum.fetch_add(value, std::memory_order_relaxed);
+        h.buckets[getBucket(value)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t max = h.max.load(std::memory_order_relaxed);
+        while(value > max && !h.max.compare_exchange_weak(max, value, std::memory_order_relaxed));
+    }
+
+    static void add(CounterId id, uint64_t n = 1) {
+        counters[(int)id].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    static void countEvent(GameWindowEventType type) {
+        events[(int)type].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void getSnapshot(GameWindowMetrics& metrics);
+
+    // Records the time until it goes out of scope
+    class Timer {
+    private:
+        HistogramId id;
+        uint64_t start;
+
+    public:
+        explicit Timer(HistogramId id) : id(id), start(GameWindow::getTimestamp()) {}
+
+        ~Timer() { record(id, GameWindow::getTimestamp() - start); }
+    };
+#else
+    static constexpr bool enabled = false;
+
+    static void record(HistogramId id, uint64_t value) {}
+
+    static void add(CounterId id, uint64_t n = 1) {}
+
+    static void countEvent(GameWindowEventType type) {}
+
+    static void getSnapshot(GameWindowMetrics& metrics) {}
+
+    class Timer {
+    public:
+        explicit Timer(HistogramId id) {}
+    };
+#endif
+};
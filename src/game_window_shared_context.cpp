@@ -0,0 +1,74 @@
+#include <game_window_shared_context.h>
+#include <game_window_manager.h>
+#include <mutex>
+
+// Sync objects are core in OpenGL 3.2 and OpenGL ES 3.0, the window context may be an ES2 one without them
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define GL_ALREADY_SIGNALED 0x911A
+#define GL_CONDITION_SATISFIED 0x911C
+
+typedef void* (*FenceSyncFunc)(unsigned int condition, unsigned int flags);
+typedef unsigned int (*ClientWaitSyncFunc)(void* sync, unsigned int flags, uint64_t timeout);
+typedef void (*DeleteSyncFunc)(void* sync);
+typedef void (*FinishFunc)();
+
+static struct {
+    std::once_flag loaded;
+    FenceSyncFunc fenceSync = nullptr;
+    ClientWaitSyncFunc clientWaitSync = nullptr;
+    DeleteSyncFunc deleteSync = nullptr;
+    FinishFunc finish = nullptr;
+} gl;
+
+static void loadFenceFunctions() {
+    std::call_once(gl.loaded, []() {
+        auto getProcAddr = GameWindowManager::getManager()->getProcAddrFunc();
+        gl.fenceSync = (FenceSyncFunc)getProcAddr("glFenceSync");
+        gl.clientWaitSync = (ClientWaitSyncFunc)getProcAddr("glClientWaitSync");
+        gl.deleteSync = (DeleteSyncFunc)getProcAddr("glDeleteSync");
+        gl.finish = (FinishFunc)getProcAddr("glFinish");
+        if (gl.fenceSync == nullptr || gl.clientWaitSync == nullptr || gl.deleteSync == nullptr)
+            gl.fenceSync = nullptr;
+    });
+}
+
+GameWindowFence& GameWindowFence::operator=(GameWindowFence&& other) {
+    if (this != &other) {
+        if (sync != nullptr)
+            gl.deleteSync(sync);
+        sync = other.sync;
+        other.sync = nullptr;
+    }
+    return *this;
+}
+
+GameWindowFence::~GameWindowFence() {
+    if (sync != nullptr)
+        gl.deleteSync(sync);
+}
+
+GameWindowFence GameWindowFence::create() {
+    loadFenceFunctions();
+    GameWindowFence fence;
+    if (gl.fenceSync != nullptr)
+        fence.sync = gl.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (fence.sync != nullptr) {
+        // Flush so the fence is guaranteed to signal even if this context issues nothing else
+        gl.clientWaitSync(fence.sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    } else if (gl.finish != nullptr) {
+        gl.finish();
+    }
+    return fence;
+}
+
+bool GameWindowFence::isSignaled() {
+    return wait(0);
+}
+
+bool GameWindowFence::wait(uint64_t timeout) {
+    if (sync == nullptr)
+        return true;
+    auto res = gl.clientWaitSync(sync, 0, timeout);
+    return res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED;
+}
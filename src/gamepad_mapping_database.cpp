@@ -0,0 +1,234 @@
+#include "gamepad_mapping_database.h"
+#include "gamepad_mapping_parser.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+
+static const char MAPPING_CACHE_MAGIC[4] = {'G', 'W', 'G', 'M'};
+static const uint32_t MAPPING_CACHE_VERSION = 1;
+
+static char toLower(char c) {
+    return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (toLower(a[i]) != toLower(b[i]))
+            return false;
+    }
+    return true;
+}
+
+// Lines without a platform field apply to all of them
+static bool matchesPlatform(std::string_view line, std::string_view platform) {
+    size_t pos = line.find(",platform:");
+    if (pos == std::string_view::npos)
+        return true;
+    std::string_view value = line.substr(pos + 10);
+    value = value.substr(0, value.find(','));
+    return value == platform;
+}
+
+const char* GamepadMappingDatabase::getDefaultPlatform() {
+#if defined(__APPLE__)
+    return "Mac OS X";
+#elif defined(_WIN32)
+    return "Windows";
+#else
+    return "Linux";
+#endif
+}
+
+uint64_t GamepadMappingDatabase::hashGuid(std::string_view guid) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : guid) {
+        hash ^= (uint8_t)toLower(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string_view GamepadMappingDatabase::getGuid(std::string_view mapping) {
+    return mapping.substr(0, mapping.find(','));
+}
+
+std::string GamepadMappingDatabase::getCacheDirectory() {
+    const char* dir = getenv("GAMEWINDOW_GAMEPAD_MAPPINGS_CACHE");
+    if (dir != nullptr)
+        return dir;
+    dir = getenv("XDG_CACHE_HOME");
+    if (dir != nullptr && *dir)
+        return std::string(dir) + "/game-window";
+    dir = getenv("HOME");
+    if (dir != nullptr && *dir)
+        return std::string(dir) + "/.cache/game-window";
+    return std::string();
+}
+
+bool GamepadMappingDatabase::isValidIndex(const char* data, size_t size) {
+    if (size < sizeof(Header))
+        return false;
+    Header header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, MAPPING_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != MAPPING_CACHE_VERSION)
+        return false;
+    if (header.entryCount > (size - sizeof(Header)) / sizeof(Entry))
+        return false;
+    auto entries = (const Entry*)(data + sizeof(Header));
+    for (uint32_t i = 0; i < header.entryCount; i++) {
+        if (entries[i].offset >= size || entries[i].length >= size - entries[i].offset || data[entries[i].offset + entries[i].length] != '\0' || entries[i].guidLength > entries[i].length)
+            return false;
+    }
+    return true;
+}
+
+std::vector<char> GamepadMappingDatabase::buildIndex(const char* data, size_t size, struct stat const& info, std::string_view platform) {
+    std::vector<std::string_view> lines;
+    // Lower case guid -> index in lines, a later line for the same guid replaces the earlier one like it did when adding them one by one
+    std::unordered_map<std::string, size_t> guids;
+    std::string guid;
+    forEachGamepadMapping(std::string_view(data, size), [&](std::string_view line) {
+        if (!matchesPlatform(line, platform))
+            return;
+        std::string_view lineGuid = getGuid(line);
+        if (lineGuid.empty() || lineGuid.size() == line.size())
+            return;
+        guid.assign(lineGuid);
+        std::transform(guid.begin(), guid.end(), guid.begin(), toLower);
+        auto it = guids.find(guid);
+        if (it != guids.end()) {
+            lines[it->second] = line;
+        } else {
+            guids.emplace(guid, lines.size());
+            lines.push_back(line);
+        }
+    });
+
+    std::vector<Entry> entries;
+    entries.reserve(lines.size());
+    size_t offset = sizeof(Header) + lines.size() * sizeof(Entry);
+    for (auto line : lines) {
+        entries.push_back({hashGuid(getGuid(line)), (uint32_t)offset, (uint32_t)line.size(), (uint32_t)getGuid(line).size(), 0});
+        offset += line.size() + 1;
+    }
+    std::sort(entries.begin(), entries.end(), [](Entry const& a, Entry const& b) { return a.hash < b.hash; });
+
+    Header header = {};
+    memcpy(header.magic, MAPPING_CACHE_MAGIC, sizeof(header.magic));
+    header.version = MAPPING_CACHE_VERSION;
+    header.sourceSize = (uint64_t)info.st_size;
+    header.sourceMtime = (int64_t)info.st_mtime;
+    header.platformHash = hashGuid(platform);
+    header.entryCount = (uint32_t)entries.size();
+
+    std::vector<char> index(offset);
+    memcpy(index.data(), &header, sizeof(header));
+    if (!entries.empty())
+        memcpy(index.data() + sizeof(Header), entries.data(), entries.size() * sizeof(Entry));
+    char* out = index.data() + sizeof(Header) + entries.size() * sizeof(Entry);
+    for (auto line : lines) {
+        memcpy(out, line.data(), line.size());
+        out[line.size()] = '\0';
+        out += line.size() + 1;
+    }
+    return index;
+}
+
+bool GamepadMappingDatabase::addFile(std::string const& path) {
+    MappedFile source;
+    if (!source.open(path))
+        return false;
+    auto& info = source.getInfo();
+
+    // Keyed by the absolute path, so different working directories don't share an index
+    std::string cachePath;
+    std::string cacheDir = getCacheDirectory();
+    if (!cacheDir.empty()) {
+        char* absPath = realpath(path.c_str(), nullptr);
+        std::string key = std::string(absPath != nullptr ? absPath : path.c_str()) + '\n' + platform;
+        free(absPath);
+        char name[32];
+        snprintf(name, sizeof(name), "/%016llx.bin", (unsigned long long)hashGuid(key));
+        cachePath = cacheDir + name;
+
+        Layer layer;
+        if (layer.file.open(cachePath) && isValidIndex(layer.file.data(), layer.file.size())) {
+            Header header;
+            memcpy(&header, layer.file.data(), sizeof(header));
+            if (header.sourceSize == (uint64_t)info.st_size && header.sourceMtime == (int64_t)info.st_mtime && header.platformHash == hashGuid(platform)) {
+                layer.data = layer.file.data();
+                layer.size = layer.file.size();
+                layers.push_back(std::move(layer));
+                return true;
+            }
+        }
+    }
+
+    Layer layer;
+    layer.memory = buildIndex(source.data(), source.size(), info, platform);
+    layer.data = layer.memory.data();
+    layer.size = layer.memory.size();
+
+    if (!cachePath.empty()) {
+        // Create the directory and its parent, then replace the index atomically so concurrent readers never see a partial one
+        size_t slash = cacheDir.rfind('/');
+        if (slash != std::string::npos && slash > 0)
+            ::mkdir(cacheDir.substr(0, slash).c_str(), 0755);
+        ::mkdir(cacheDir.c_str(), 0755);
+        std::string tmpPath = cachePath + "." + std::to_string(getpid()) + ".tmp";
+        FILE* f = fopen(tmpPath.c_str(), "wb");
+        if (f != nullptr) {
+            bool written = fwrite(layer.memory.data(), 1, layer.memory.size(), f) == layer.memory.size();
+            written = fclose(f) == 0 && written;
+            if (!written || rename(tmpPath.c_str(), cachePath.c_str()) != 0)
+                remove(tmpPath.c_str());
+        }
+    }
+    layers.push_back(std::move(layer));
+    return true;
+}
+
+void GamepadMappingDatabase::append(GamepadMappingDatabase&& other) {
+    for (auto& layer : other.layers)
+        layers.push_back(std::move(layer));
+    other.layers.clear();
+    other.overrides.clear();
+}
+
+void GamepadMappingDatabase::addOverride(std::string_view mappings) {
+    forEachGamepadMapping(mappings, [&](std::string_view line) {
+        std::string_view guid = getGuid(line);
+        if (!guid.empty() && matchesPlatform(line, platform))
+            overrides[hashGuid(guid)] = layers.size();
+    });
+}
+
+std::string_view GamepadMappingDatabase::find(std::string_view guid) const {
+    if (guid.empty())
+        return std::string_view();
+    uint64_t hash = hashGuid(guid);
+    size_t first = 0;
+    auto it = overrides.find(hash);
+    if (it != overrides.end())
+        first = it->second;
+    for (size_t i = layers.size(); i > first; i--) {
+        auto& layer = layers[i - 1];
+        Header header;
+        memcpy(&header, layer.data, sizeof(header));
+        auto entries = (const Entry*)(layer.data + sizeof(Header));
+        auto end = entries + header.entryCount;
+        auto entry = std::lower_bound(entries, end, hash, [](Entry const& e, uint64_t hash) { return e.hash < hash; });
+        for (; entry != end && entry->hash == hash; entry++) {
+            std::string_view line(layer.data + entry->offset, entry->length);
+            if (equalsIgnoreCase(line.substr(0, entry->guidLength), guid))
+                return line;
+        }
+    }
+    return std::string_view();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "mapped_file.h"
+
+// SDL style gamepad mappings, looked up by joystick guid when a device connects instead of handing every line to the backend
+// Each file is filtered for the platform and indexed once, the index is cached in GAMEWINDOW_GAMEPAD_MAPPINGS_CACHE,
+// $XDG_CACHE_HOME/game-window or ~/.cache/game-window and memory mapped on later runs, an empty variable disables the cache
+class GamepadMappingDatabase {
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceSize;
+        int64_t sourceMtime;
+        uint64_t platformHash;
+        uint32_t entryCount;
+        uint32_t reserved;
+    };
+    // Sorted by hash, followed by the null terminated mapping lines
+    struct Entry {
+        uint64_t hash;
+        uint32_t offset;
+        uint32_t length;
+        uint32_t guidLength;
+        uint32_t reserved;
+    };
+    struct Layer {
+        MappedFile file;
+        std::vector<char> memory;
+        const char* data;
+        size_t size;
+    };
+
+    std::string platform;
+    std::vector<Layer> layers;
+    // Guid of an explicitly added mapping -> number of layers it overrides
+    std::unordered_map<uint64_t, size_t> overrides;
+
+    static uint64_t hashGuid(std::string_view guid);
+    static std::string getCacheDirectory();
+
+    static bool isValidIndex(const char* data, size_t size);
+    static std::vector<char> buildIndex(const char* data, size_t size, struct stat const& info, std::string_view platform);
+
+public:
+    // Name used in the platform field of the mappings for this build
+    static const char* getDefaultPlatform();
+
+    explicit GamepadMappingDatabase(std::string platform = getDefaultPlatform()) : platform(std::move(platform)) {}
+
+    // Mappings of later files take precedence, returns false if the file couldn't be read
+    bool addFile(std::string const& path);
+
+    // Appends the files of other as if they were added after the ones of this database, its overrides are dropped
+    void append(GamepadMappingDatabase&& other);
+
+    // Records the guid of mappings added to the backend directly, so the files added before don't replace them
+    void addOverride(std::string_view mappings);
+
+    // Returns an empty view if there is none, the view is null terminated and remains valid until the database is destroyed
+    std::string_view find(std::string_view guid) const;
+
+    // The guid field of a mapping line
+    static std::string_view getGuid(std::string_view mapping);
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string_view>
+#include <cstring>
+#include "mapped_file.h"
+
+// Calls callback(std::string_view line) for every mapping in content, skipping blank lines and # comments
+// The lines point into content and have the line ending stripped, nothing is copied
+template <typename Callback>
+void forEachGamepadMapping(std::string_view content, Callback&& callback) {
+    const char* data = content.data();
+    size_t size = content.size();
+    for (size_t i = 0; i < size; ) {
+        const char* end = (const char*)memchr(data + i, '\n', size - i);
+        size_t j = end != nullptr ? (size_t)(end - data) : size;
+        std::string_view line(data + i, j - i);
+        i = j + 1;
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t'))
+            line.remove_suffix(1);
+        while (!line.empty() && (line.front() == ' ' || line.front() == '\t'))
+            line.remove_prefix(1);
+        if (line.empty() || line[0] == '#')
+            continue;
+        callback(line);
+    }
+}
+
+// Memory maps the file instead of reading it, the fd stays owned by the caller
+// Returns false if it isn't a readable regular file
+template <typename Callback>
+bool forEachGamepadMapping(int fd, Callback&& callback) {
+    MappedFile file;
+    if (!file.open(fd))
+        return false;
+    forEachGamepadMapping(std::string_view(file.data(), file.size()), callback);
+    return true;
+}
@@ -1,6 +1,7 @@
 #include "joystick_manager.h"
 #include <game_window_manager.h>
 #include <sstream>
+#include <cstdlib>
 
 bool JoystickManager::handleMissingGamePadMapping(std::string name, std::string guid, int axescount, int buttonscount, int hatscount, std::function<bool(std::string mapping)> updateMapping) {
 #ifndef NDEBUG
@@ -52,3 +53,50 @@ bool JoystickManager::handleMissingGamePadMapping(std::string name, std::string
         return false;
 #endif
 }
+
+bool JoystickManager::DefaultMappings::defer(bool isFile, std::string const& value) {
+    if (loaded)
+        return false;
+    pendingMappings.push_back({isFile, value});
+    return true;
+}
+
+JoystickManager::DefaultMappings::~DefaultMappings() {
+    if (prefetchThread.joinable())
+        prefetchThread.join();
+}
+
+void JoystickManager::DefaultMappings::readDatabase() {
+    // An empty GAMEWINDOW_GAMEPAD_MAPPINGS disables the lookup in the working directory
+    const char* path = getenv("GAMEWINDOW_GAMEPAD_MAPPINGS");
+    if (path == nullptr)
+        path = "gamecontrollerdb.txt";
+    if (*path)
+        databaseRead = database.addFile(path);
+}
+
+void JoystickManager::DefaultMappings::prefetch() {
+    if (loaded || prefetchThread.joinable())
+        return;
+    prefetchThread = std::thread(&DefaultMappings::readDatabase, this);
+}
+
+void JoystickManager::DefaultMappings::load(std::function<void(GamepadMappingDatabase&& database)> loadDatabase, std::function<void(std::string const& path)> loadFile, std::function<void(std::string const& content)> loadContent) {
+    if (loaded)
+        return;
+    loaded = true;
+    if (prefetchThread.joinable())
+        prefetchThread.join();
+    else
+        readDatabase();
+    if (databaseRead)
+        loadDatabase(std::move(database));
+    for (auto& mapping : pendingMappings) {
+        if (mapping.isFile)
+            loadFile(mapping.value);
+        else
+            loadContent(mapping.value);
+    }
+    pendingMappings.clear();
+    pendingMappings.shrink_to_fit();
+}
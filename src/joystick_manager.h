@@ -1,8 +1,47 @@
 #pragma once
 #include <string>
+#include <vector>
 #include <functional>
+#include <thread>
+#include "gamepad_mapping_database.h"
 
 class JoystickManager {
 public:
     static bool handleMissingGamePadMapping(std::string name, std::string guid, int axis, int buttons, int hats, std::function<bool(std::string mapping)> updateMapping);
+
+    // Mappings added before the default database was loaded, applied after it so they take precedence
+    class DefaultMappings {
+    private:
+        struct PendingMapping {
+            bool isFile;
+            std::string value;
+        };
+        bool loaded = false;
+        std::vector<PendingMapping> pendingMappings;
+        // Indexing a database with thousands of lines is measurable, prefetch does it on this thread
+        std::thread prefetchThread;
+        GamepadMappingDatabase database;
+        bool databaseRead = false;
+
+        void readDatabase();
+
+    public:
+        DefaultMappings() {}
+
+        DefaultMappings(DefaultMappings const&) = delete;
+
+        DefaultMappings& operator=(DefaultMappings const&) = delete;
+
+        ~DefaultMappings();
+
+        // True if the mapping was queued because the default database isn't loaded yet
+        bool defer(bool isFile, std::string const& value);
+
+        // Starts reading the default database on a worker, so load doesn't have to wait for the file
+        void prefetch();
+
+        // Hands GAMEWINDOW_GAMEPAD_MAPPINGS or gamecontrollerdb.txt in the working directory to loadDatabase once, then loads the queued mappings
+        // Waits for a running prefetch, reads the database on the calling thread without one
+        void load(std::function<void(GamepadMappingDatabase&& database)> loadDatabase, std::function<void(std::string const& path)> loadFile, std::function<void(std::string const& content)> loadContent);
+    };
 };
\ No newline at end of file
@@ -1,53 +1,84 @@
 #include "joystick_manager_glfw.h"
 
 #include <cstring>
-#include <fstream>
+#include <cstdlib>
 #include "window_glfw.h"
 #include "joystick_manager.h"
+#include "game_window_metrics_collector.h"
 #include "game_window_manager.h"
 
 std::unordered_set<GLFWGameWindow*> GLFWJoystickManager::windows;
 GLFWGameWindow* GLFWJoystickManager::focusedWindow;
-std::unordered_map<int, GLFWJoystickManager::JoystickInfo> GLFWJoystickManager::connectedJoysticks;
-std::unordered_set<int> GLFWJoystickManager::userIds;
+GLFWJoystickManager::JoystickInfo GLFWJoystickManager::joysticks[GLFW_JOYSTICK_LAST + 1];
+uint32_t GLFWJoystickManager::userIds;
+JoystickManager::DefaultMappings GLFWJoystickManager::defaultMappings;
+GamepadMappingDatabase GLFWJoystickManager::mappingDatabase;
 
 void GLFWJoystickManager::init() {
     glfwSetJoystickCallback(_glfwJoystickCallback);
-    loadMappingsFromFile("gamecontrollerdb.txt");
+    // Read while the first window is created, addWindow waits for it
+    defaultMappings.prefetch();
+}
+
+void GLFWJoystickManager::loadDefaultMappings() {
+    defaultMappings.load([](GamepadMappingDatabase&& database) {
+        mappingDatabase.append(std::move(database));
+        applyDatabaseMappings();
+    }, loadMappingsFromFile, loadMappings);
 }
 
 void GLFWJoystickManager::loadMappingsFromFile(std::string const& path) {
-    std::ifstream fs(path);
-    if (!fs)
+    if (defaultMappings.defer(true, path))
         return;
-    std::string line;
-    while (std::getline(fs, line)) {
-        if (!line.empty())
-            loadMappings(line);
-    }
+    if (mappingDatabase.addFile(path))
+        applyDatabaseMappings();
 }
 
 void GLFWJoystickManager::loadMappings(const std::string &content) {
+    if (defaultMappings.defer(false, content))
+        return;
     glfwUpdateGamepadMappings(content.c_str());
+    mappingDatabase.addOverride(content);
+}
+
+void GLFWJoystickManager::applyDatabaseMapping(int joystick) {
+    const char* guid = glfwGetJoystickGUID(joystick);
+    if (guid == nullptr)
+        return;
+    auto mapping = mappingDatabase.find(guid);
+    if (!mapping.empty())
+        glfwUpdateGamepadMappings(mapping.data());
+}
+
+void GLFWJoystickManager::applyDatabaseMappings() {
+    for (int i = GLFW_JOYSTICK_1; i <= GLFW_JOYSTICK_LAST; i++) {
+        if (glfwJoystickPresent(i))
+            applyDatabaseMapping(i);
+    }
 }
 
 int GLFWJoystickManager::nextUnassignedUserId() {
-    for (int i = 0; ; i++) {
-        if (userIds.count(i) <= 0)
+    for (int i = 0; i < GameWindow::MAX_GAMEPADS; i++) {
+        if (!(userIds & (1u << i)))
             return i;
     }
+    return -1;
 }
 
 void GLFWJoystickManager::update(GLFWGameWindow* window) {
     if (focusedWindow != window)
         return;
 
-    for (auto& j : connectedJoysticks) {
+    GameWindowMetricsCollector::Timer timer(GameWindowMetricsCollector::HistogramId::GAMEPAD_POLL_DURATION);
+    for (int jid = 0; jid <= GLFW_JOYSTICK_LAST; jid++) {
+        auto& j = joysticks[jid];
+        if (!j.connected)
+            continue;
         GLFWgamepadstate state;
-        glfwGetGamepadState(j.first, &state);
+        glfwGetGamepadState(jid, &state);
         for (int i = 0; i <= GLFW_GAMEPAD_BUTTON_LAST; i++) {
-            if (state.buttons[i] != j.second.oldButtonStates[i]) {
-                window->onGamepadButton(j.second.userId, mapButtonId(i), state.buttons[i] != 0);
+            if (state.buttons[i] != j.oldButtonStates[i]) {
+                window->onGamepadButton(j.userId, mapButtonId(i), state.buttons[i] != 0);
             }
         }
         for (int i = 0; i <= GLFW_GAMEPAD_AXIS_LAST; i++) {
@@ -58,10 +89,10 @@ void GLFWJoystickManager::update(GLFWGameWindow* window) {
                 value = value / 2.0f + 0.5f;
             break;
             }
-            window->onGamepadAxis(j.second.userId, mapAxisId(i), value);
+            window->onGamepadAxis(j.userId, mapAxisId(i), value);
         }
 
-        memcpy(j.second.oldButtonStates, state.buttons, GLFW_GAMEPAD_BUTTON_LAST + 1);
+        memcpy(j.oldButtonStates, state.buttons, GLFW_GAMEPAD_BUTTON_LAST + 1);
     }
 }
 
@@ -72,6 +103,8 @@ void GLFWJoystickManager::update() {
 void GLFWJoystickManager::addWindow(GLFWGameWindow* window) {
     windows.insert(window);
     if (windows.size() == 1) {
+        // Waits for the database prefetched since init
+        loadDefaultMappings();
         // First window created poll all joysticks for valid mappings etc.
         // Doing this earlier can cause unintenional errors if muliple mapping are added before the first window is created
         for (int i = GLFW_JOYSTICK_1; i <= GLFW_JOYSTICK_LAST; i++) {
@@ -81,8 +114,10 @@ void GLFWJoystickManager::addWindow(GLFWGameWindow* window) {
         }
     } else {
         // Only newly added window gets the events
-        for (auto& joystick : connectedJoysticks)
-            window->onGamepadState(joystick.second.userId, true);
+        for (auto& joystick : joysticks) {
+            if (joystick.connected)
+                window->onGamepadState(joystick.userId, true);
+        }
     }
 }
 
@@ -98,9 +133,12 @@ void GLFWJoystickManager::onWindowFocused(GLFWGameWindow* window, bool focused)
 }
 
 void GLFWJoystickManager::_glfwJoystickCallback(int joystick, int action) {
-    auto js = connectedJoysticks.find(joystick);
+    if (joystick < 0 || joystick > GLFW_JOYSTICK_LAST)
+        return;
+    auto& js = joysticks[joystick];
     int userId;
     if (action == GLFW_CONNECTED) {
+        applyDatabaseMapping(joystick);
         if (!glfwJoystickIsGamepad(joystick)) {
             if (windows.empty()) {
                 // No Warning before first window is created
@@ -125,17 +163,24 @@ void GLFWJoystickManager::_glfwJoystickCallback(int joystick, int action) {
             }
         }
 
-        if (js != connectedJoysticks.end())
+        if (js.connected)
             return;
         userId = nextUnassignedUserId();
-        userIds.insert(userId);
-        connectedJoysticks.insert({joystick, JoystickInfo(userId)});
+        if (userId == -1)
+            return;
+        userIds |= 1u << userId;
+        js = JoystickInfo();
+        js.connected = true;
+        js.userId = userId;
+        memset(js.oldButtonStates, 0, sizeof(js.oldButtonStates));
     } else if (action == GLFW_DISCONNECTED) {
-        if (js == connectedJoysticks.end())
+        if (!js.connected)
             return;
-        userId = js->second.userId;
-        userIds.erase(userId);
-        connectedJoysticks.erase(joystick);
+        userId = js.userId;
+        userIds &= ~(1u << userId);
+        js.connected = false;
+    } else {
+        return;
     }
 
     for (GLFWGameWindow* window : windows)
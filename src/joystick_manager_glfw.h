@@ -1,9 +1,12 @@
 #pragma once
 
 #include <unordered_set>
-#include <unordered_map>
+#include <vector>
+#include <string>
 #include <GLFW/glfw3.h>
 #include <game_window.h>
+#include "gamepad_mapping_database.h"
+#include "joystick_manager.h"
 
 class GLFWGameWindow;
 
@@ -11,16 +14,26 @@ class GLFWJoystickManager {
 
 private:
     struct JoystickInfo {
-        int userId;
+        bool connected = false;
+        int userId = -1;
         char oldButtonStates[GLFW_GAMEPAD_BUTTON_LAST + 1];
-
-        JoystickInfo(int id) : userId(id) {}
     };
 
     static std::unordered_set<GLFWGameWindow*> windows;
     static GLFWGameWindow* focusedWindow;
-    static std::unordered_map<int, JoystickInfo> connectedJoysticks;
-    static std::unordered_set<int> userIds;
+    // Indexed by the glfw joystick id
+    static JoystickInfo joysticks[GLFW_JOYSTICK_LAST + 1];
+    // Bit (1 << userId) per assigned user id
+    static uint32_t userIds;
+
+    static JoystickManager::DefaultMappings defaultMappings;
+
+    // Files are only indexed, the mapping of a joystick is handed to glfw when it connects
+    static GamepadMappingDatabase mappingDatabase;
+
+    static void loadDefaultMappings();
+    static void applyDatabaseMapping(int joystick);
+    static void applyDatabaseMappings();
 
     static int nextUnassignedUserId();
 
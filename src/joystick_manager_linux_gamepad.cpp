@@ -7,6 +7,8 @@
 #include <sstream>
 #include <gamepad/gamepad_mapping.h>
 #include "joystick_manager.h"
+#include "gamepad_mapping_parser.h"
+#include "game_window_metrics_collector.h"
 #include <game_window_manager.h>
 
 LinuxGamepadJoystickManager LinuxGamepadJoystickManager::instance;
@@ -18,56 +20,203 @@ LinuxGamepadJoystickManager::LinuxGamepadJoystickManager() : joystickManager(gam
     gamepadManager.onGamepadDisconnected.add(std::bind(&LinuxGamepadJoystickManager::onGamepadState, this, _1, false));
     gamepadManager.onGamepadButton.add(std::bind(&LinuxGamepadJoystickManager::onGamepadButton, this, _1, _2, _3));
     gamepadManager.onGamepadAxis.add(std::bind(&LinuxGamepadJoystickManager::onGamepadAxis, this, _1, _2, _3));
+}
 
-    loadMappingsFromFile("gamecontrollerdb.txt");
+LinuxGamepadJoystickManager::~LinuxGamepadJoystickManager() {
+    pollThreadRunning = false;
+    if (pollThread.joinable())
+        pollThread.join();
 }
 
 void LinuxGamepadJoystickManager::initialize() {
     if (!initialized) {
         initialized = true;
+        // Deferred from static initialization, the mappings have to be known before the joysticks are enumerated
+        loadDefaultMappings();
         joystickManager->initialize();
+        if (getenv("GAMEWINDOW_GAMEPAD_THREAD")) {
+            threaded = true;
+            pollThreadRunning = true;
+            pollThread = std::thread(&LinuxGamepadJoystickManager::runPollThread, this);
+        }
     }
 }
 
 void LinuxGamepadJoystickManager::update(WindowWithLinuxJoystick* window) {
+    if (threaded) {
+        // The devices are read by the poll thread, only handing out its records is left to the window
+        GameWindowMetricsCollector::Timer timer(GameWindowMetricsCollector::HistogramId::GAMEPAD_POLL_DURATION);
+        drainRecords(window);
+        return;
+    }
     if (focusedWindow != window)
         return;
 
+    GameWindowMetricsCollector::Timer timer(GameWindowMetricsCollector::HistogramId::GAMEPAD_POLL_DURATION);
     initialize();
     joystickManager->poll();
 }
 
-void LinuxGamepadJoystickManager::loadMappingsFromFile(std::string const& path) {
-    std::ifstream fs(path);
-    if (!fs)
+void LinuxGamepadJoystickManager::runPollThread() {
+    while (pollThreadRunning) {
+        {
+            std::lock_guard<std::recursive_mutex> lock(pollMutex);
+            joystickManager->poll();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void LinuxGamepadJoystickManager::queueRecord(GamepadRecord const& record) {
+    if (record.type == GamepadRecord::Type::CONNECTED || record.type == GamepadRecord::Type::DISCONNECTED) {
+        std::lock_guard<std::mutex> lock(stateRecordsMutex);
+        stateRecords.push_back(record);
+        queuedStateRecords++;
         return;
-    std::string line;
-    while (std::getline(fs, line)) {
-        if (!line.empty() && line[0] != '#') {
-            try {
-                gamepadManager.addMapping(line);
-            } catch (std::exception& e) {
-                printf("Invalid mapping in %s: %s\n", path.c_str(), e.what());
-            }
+    }
+    GamepadRecord queued = record;
+    queued.stateRecordsBefore = queuedStateRecords;
+    // Input is dropped if the windows didn't pump events for a long time
+    records.push(queued);
+}
+
+void LinuxGamepadJoystickManager::drainRecords(WindowWithLinuxJoystick* window) {
+    GamepadRecord record;
+    while (records.pop(record)) {
+        deliverStateRecords(record.stateRecordsBefore);
+        // Delivered to the focused window whichever window drains, the records are gone afterwards
+        if (focusedWindow != nullptr)
+            focusedWindow->setEventTimestamp(record.timestamp);
+        if (record.type == GamepadRecord::Type::BUTTON)
+            reportButton(record.index, (GamepadButtonId)record.id, record.value != 0.0f);
+        else
+            reportAxis(record.index, (GamepadAxisId)record.id, record.value);
+        if (focusedWindow != nullptr)
+            focusedWindow->setEventTimestamp(0);
+    }
+    uint64_t queued;
+    {
+        std::lock_guard<std::mutex> lock(stateRecordsMutex);
+        queued = deliveredStateRecords + stateRecords.size();
+    }
+    deliverStateRecords(queued);
+}
+
+void LinuxGamepadJoystickManager::deliverStateRecords(uint64_t count) {
+    while (deliveredStateRecords < count) {
+        GamepadRecord record;
+        {
+            std::lock_guard<std::mutex> lock(stateRecordsMutex);
+            record = stateRecords.front();
+            stateRecords.pop_front();
+        }
+        deliveredStateRecords++;
+        bool connected = record.type == GamepadRecord::Type::CONNECTED;
+        if (connected) {
+            std::lock_guard<std::recursive_mutex> lock(pollMutex);
+            // The gamepad may already be gone again
+            if (gamepads.count(record.gamepad))
+                warnOnMissingGamePadMapping(record.gamepad);
+        } else {
+            reportedInput.erase(record.index);
         }
+        for (auto w : windows) {
+            w->setEventTimestamp(record.timestamp);
+            w->onGamepadState(record.index, connected);
+            w->setEventTimestamp(0);
+        }
+    }
+}
+
+void LinuxGamepadJoystickManager::reportButton(int index, GamepadButtonId btn, bool pressed) {
+    if (focusedWindow == nullptr)
+        return;
+    int bit = (int)btn;
+    if (bit >= 0 && bit < 32) {
+        auto& reported = reportedInput[index];
+        if (pressed)
+            reported.buttons |= 1u << bit;
+        else
+            reported.buttons &= ~(1u << bit);
     }
+    focusedWindow->onGamepadButton(index, btn, pressed);
+}
+
+void LinuxGamepadJoystickManager::reportAxis(int index, GamepadAxisId axis, float value) {
+    if (focusedWindow == nullptr)
+        return;
+    int i = (int)axis;
+    if (i >= 0 && i < 6)
+        reportedInput[index].axes[i] = value;
+    focusedWindow->onGamepadAxis(index, axis, value);
+}
+
+void LinuxGamepadJoystickManager::prefetchDefaultMappings() {
+    std::lock_guard<std::recursive_mutex> lock(pollMutex);
+    defaultMappings.prefetch();
+}
+
+void LinuxGamepadJoystickManager::loadDefaultMappings() {
+    defaultMappings.load([this](GamepadMappingDatabase&& database) {
+        std::lock_guard<std::recursive_mutex> lock(pollMutex);
+        mappingDatabase.append(std::move(database));
+        for (gamepad::Gamepad* gp : gamepads)
+            applyDatabaseMapping(gp);
+    }, [this](std::string const& path) { loadMappingsFromFile(path); }, [this](std::string const& content) { loadMappings(content); });
+}
+
+void LinuxGamepadJoystickManager::loadMappingsFromFile(std::string const& path) {
+    std::lock_guard<std::recursive_mutex> lock(pollMutex);
+    if (defaultMappings.defer(true, path))
+        return;
+    if (!mappingDatabase.addFile(path))
+        return;
+    for (gamepad::Gamepad* gp : gamepads)
+        applyDatabaseMapping(gp);
 }
 
 void LinuxGamepadJoystickManager::loadMappings(const std::string &content) {
-    for (size_t i = 0; i < content.length(); ) {
-        size_t j = content.find('\n', i);
-        std::string line = content.substr(i,  j);
-        gamepadManager.addMapping(line);
-        if (j == std::string::npos) {
-            // last line
-            break;
+    std::lock_guard<std::recursive_mutex> lock(pollMutex);
+    if (defaultMappings.defer(false, content))
+        return;
+    std::string line;
+    forEachGamepadMapping(content, [&](std::string_view mapping) {
+        line.assign(mapping);
+        try {
+            gamepadManager.addMapping(line);
+        } catch (std::exception& e) {
+            printf("Invalid mapping: %s\n", e.what());
         }
-        i = j + 1;
+    });
+    mappingDatabase.addOverride(content);
+}
+
+void LinuxGamepadJoystickManager::applyDatabaseMapping(gamepad::Gamepad* gp) {
+    auto mapping = mappingDatabase.find(gp->getJoystick().getGUID());
+    if (mapping.empty())
+        return;
+    try {
+        gamepadManager.addMapping(std::string(mapping));
+        setGamepadMapping(gp, std::string(mapping));
+    } catch (std::exception& e) {
+        printf("Invalid mapping for %s: %s\n", gp->getJoystick().getGUID().c_str(), e.what());
     }
 }
 
+void LinuxGamepadJoystickManager::setGamepadMapping(gamepad::Gamepad* gp, std::string const& mapping) {
+    // Update Gamepad, needed to add refresh mapping
+    auto& joystick = (gamepad::Joystick&)gp->getJoystick();
+    auto m = std::make_shared<gamepad::GamepadMapping>();
+    m->parse(mapping);
+    auto index = gp->getIndex();
+    gp->~Gamepad();
+    new (gp) gamepad::Gamepad(index, joystick, *m.get());
+    unknownmappings.push_back(std::move(m));
+}
+
 void LinuxGamepadJoystickManager::addWindow(WindowWithLinuxJoystick* window) {
     initialize();
+    std::lock_guard<std::recursive_mutex> lock(pollMutex);
     windows.insert(window);
     if (windows.size() == 1) {
         // First window created poll all joysticks for valid mappings etc.
@@ -85,22 +234,51 @@ void LinuxGamepadJoystickManager::addWindow(WindowWithLinuxJoystick* window) {
 
 void LinuxGamepadJoystickManager::removeWindow(WindowWithLinuxJoystick* window) {
     windows.erase(window);
+    if (focusedWindow == window) {
+        focusedWindow = nullptr;
+        reportedInput.clear();
+    }
 }
 
 void LinuxGamepadJoystickManager::onWindowFocused(WindowWithLinuxJoystick* window, bool focused) {
-    if (focused)
-        focusedWindow = window;
-    else if (focusedWindow == window /* && !focused */)
-        focusedWindow = nullptr;
+    auto next = focused ? window : (focusedWindow == window ? nullptr : focusedWindow);
+    if (focusedWindow != nullptr && next != focusedWindow) {
+        // Input is only delivered to the focused window, so the releases wouldn't reach the window losing focus
+        for (auto& entry : reportedInput) {
+            for (int i = 0; i < 32; i++) {
+                if (entry.second.buttons & (1u << i))
+                    focusedWindow->onGamepadButton(entry.first, (GamepadButtonId)i, false);
+            }
+            for (int i = 0; i < 6; i++) {
+                if (entry.second.axes[i] != 0.0f)
+                    focusedWindow->onGamepadAxis(entry.first, (GamepadAxisId)i, 0.0f);
+            }
+        }
+        reportedInput.clear();
+    }
+    focusedWindow = next;
 }
 
 void LinuxGamepadJoystickManager::onGamepadState(gamepad::Gamepad* gp, bool connected) {
+    if (threaded) {
+        // Runs on the poll thread, the windows are notified by drainRecords
+        if (connected) {
+            applyDatabaseMapping(gp);
+            gamepads.insert(gp);
+        } else
+            gamepads.erase(gp);
+        queueRecord({connected ? GamepadRecord::Type::CONNECTED : GamepadRecord::Type::DISCONNECTED, gp->getIndex(), 0, 0.0f, GameWindow::getTimestamp(), gp});
+        return;
+    }
     if (connected) {
+        applyDatabaseMapping(gp);
         warnOnMissingGamePadMapping(gp);
         gamepads.insert(gp);
     }
-    else
+    else {
         gamepads.erase(gp);
+        reportedInput.erase(gp->getIndex());
+    }
 
     for (auto window : windows)
         window->onGamepadState(gp->getIndex(), connected);
@@ -113,16 +291,8 @@ void LinuxGamepadJoystickManager::warnOnMissingGamePadMapping(gamepad::Gamepad*
         }
         if (!JoystickManager::handleMissingGamePadMapping("Unknown", gp->getJoystick().getGUID(), 4, 12, 1, [&](std::string mapping) {
             GameWindowManager::getManager()->addGamePadMapping(mapping);
-            if (gp->getMapping().mappings.empty()) {
-                // Update Gamepad, needed to add refresh mapping
-                auto& joystick = (gamepad::Joystick&)gp->getJoystick();
-                auto m = std::make_shared<gamepad::GamepadMapping>();
-                m->parse(mapping);
-                auto index = gp->getIndex();
-                gp->~Gamepad();
-                new (gp) gamepad::Gamepad(index, joystick, *m.get());
-                unknownmappings.push_back(std::move(m));
-            }
+            if (gp->getMapping().mappings.empty())
+                setGamepadMapping(gp, mapping);
             return !gp->getMapping().mappings.empty();
         })) {
             // Default empty mapping
@@ -132,13 +302,19 @@ void LinuxGamepadJoystickManager::warnOnMissingGamePadMapping(gamepad::Gamepad*
 }
 
 void LinuxGamepadJoystickManager::onGamepadButton(gamepad::Gamepad* gp, gamepad::GamepadButton btn, bool state) {
-    if (focusedWindow != nullptr)
-        focusedWindow->onGamepadButton(gp->getIndex(), mapButtonId(btn), state);
+    if (threaded) {
+        queueRecord({GamepadRecord::Type::BUTTON, gp->getIndex(), (int)mapButtonId(btn), state ? 1.0f : 0.0f, GameWindow::getTimestamp(), gp});
+        return;
+    }
+    reportButton(gp->getIndex(), mapButtonId(btn), state);
 }
 
 void LinuxGamepadJoystickManager::onGamepadAxis(gamepad::Gamepad* gp, gamepad::GamepadAxis axis, float value) {
-    if (focusedWindow != nullptr)
-        focusedWindow->onGamepadAxis(gp->getIndex(), mapAxisId(axis), value);
+    if (threaded) {
+        queueRecord({GamepadRecord::Type::AXIS, gp->getIndex(), (int)mapAxisId(axis), value, GameWindow::getTimestamp(), gp});
+        return;
+    }
+    reportAxis(gp->getIndex(), mapAxisId(axis), value);
 }
 
 GamepadButtonId LinuxGamepadJoystickManager::mapButtonId(gamepad::GamepadButton id) {
@@ -2,8 +2,15 @@
 
 #include <unordered_set>
 #include <unordered_map>
+#include <deque>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <game_window.h>
+#include "spsc_ring_buffer.h"
+#include "gamepad_mapping_database.h"
+#include "joystick_manager.h"
 #include <gamepad/gamepad_ids.h>
 #include <gamepad/gamepad.h>
 #include <gamepad/joystick_manager.h>
@@ -22,6 +29,53 @@ private:
     gamepad::GamepadManager gamepadManager;
     std::vector<std::shared_ptr<gamepad::GamepadMapping>> unknownmappings;
 
+    // Pressed buttons and deflected axes reported to focusedWindow, released when it loses focus
+    struct ReportedInput {
+        uint32_t buttons = 0;
+        float axes[6] = {};
+    };
+    std::unordered_map<int, ReportedInput> reportedInput;
+
+    void reportButton(int index, GamepadButtonId btn, bool pressed);
+    void reportAxis(int index, GamepadAxisId axis, float value);
+
+    JoystickManager::DefaultMappings defaultMappings;
+
+    // Files are only indexed, the mapping of a gamepad is handed to linux-gamepad when it connects
+    GamepadMappingDatabase mappingDatabase;
+
+    void loadDefaultMappings();
+    void applyDatabaseMapping(gamepad::Gamepad* gp);
+    void setGamepadMapping(gamepad::Gamepad* gp, std::string const& mapping);
+
+    // GAMEWINDOW_GAMEPAD_THREAD mode, linux-gamepad doesn't expose its fds so a thread polls it continuously
+    struct GamepadRecord {
+        enum class Type { CONNECTED, DISCONNECTED, BUTTON, AXIS } type;
+        int index;
+        int id;
+        float value;
+        uint64_t timestamp;
+        gamepad::Gamepad* gamepad;
+        // Connection records queued before this one, orders the records of both queues
+        uint64_t stateRecordsBefore = 0;
+    };
+    bool threaded = false;
+    std::thread pollThread;
+    std::atomic<bool> pollThreadRunning{false};
+    // Held by the poll thread while polling, guards the gamepads and mappings against it
+    std::recursive_mutex pollMutex;
+    SpscRingBuffer<GamepadRecord> records{1024};
+    // Connections must never be dropped, unlike input they don't fit a fixed ring
+    std::mutex stateRecordsMutex;
+    std::deque<GamepadRecord> stateRecords;
+    // Only used by the poll thread and the draining thread respectively
+    uint64_t queuedStateRecords = 0, deliveredStateRecords = 0;
+
+    void runPollThread();
+    void queueRecord(GamepadRecord const& record);
+    void drainRecords(WindowWithLinuxJoystick* window);
+    void deliverStateRecords(uint64_t count);
+
     static GamepadButtonId mapButtonId(gamepad::GamepadButton id);
     static GamepadAxisId mapAxisId(gamepad::GamepadAxis id);
 
@@ -35,8 +89,13 @@ public:
 
     LinuxGamepadJoystickManager();
 
+    ~LinuxGamepadJoystickManager();
+
     void initialize();
 
+    // Starts reading the default mappings on a worker, initialize waits for them
+    void prefetchDefaultMappings();
+
     void loadMappingsFromFile(std::string const& path);
     void loadMappings(std::string const& content);
 
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Read only memory mapping of a whole file
+class MappedFile {
+private:
+    void* mapping = nullptr;
+    size_t length = 0;
+    struct stat info = {};
+
+public:
+    MappedFile() {}
+
+    MappedFile(MappedFile const&) = delete;
+
+    MappedFile(MappedFile&& other) : mapping(other.mapping), length(other.length), info(other.info) {
+        other.mapping = nullptr;
+        other.length = 0;
+    }
+
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    MappedFile& operator=(MappedFile&& other) {
+        if (this != &other) {
+            close();
+            mapping = other.mapping;
+            length = other.length;
+            info = other.info;
+            other.mapping = nullptr;
+            other.length = 0;
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        close();
+    }
+
+    // The fd stays owned by the caller, the mapping remains valid after it was closed
+    bool open(int fd) {
+        close();
+        if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+            return false;
+        length = (size_t)info.st_size;
+        if (length == 0)
+            return true;
+        void* ptr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+            length = 0;
+            return false;
+        }
+        mapping = ptr;
+        return true;
+    }
+
+    bool open(std::string const& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+        bool ret = open(fd);
+        ::close(fd);
+        return ret;
+    }
+
+    void close() {
+        if (mapping != nullptr)
+            munmap(mapping, length);
+        mapping = nullptr;
+        length = 0;
+    }
+
+    const char* data() const {
+        return (const char*)mapping;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    // Of the file when it was mapped
+    struct stat const& getInfo() const {
+        return info;
+    }
+};
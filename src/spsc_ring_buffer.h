@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Lock-free ring for exactly one producer and one consumer thread, the capacity is rounded up to a power of two
+template <typename T>
+class SpscRingBuffer {
+private:
+    std::unique_ptr<T[]> data;
+    size_t mask;
+    // Only written by the consumer and producer respectively, aligned to avoid false sharing
+    alignas(64) std::atomic<size_t> readPos{0};
+    alignas(64) std::atomic<size_t> writePos{0};
+
+    static size_t roundCapacity(size_t capacity) {
+        size_t ret = 1;
+        while(ret < capacity)
+            ret <<= 1;
+        return ret;
+    }
+
+public:
+    explicit SpscRingBuffer(size_t capacity) : data(new T[roundCapacity(capacity)]), mask(roundCapacity(capacity) - 1) {}
+
+    size_t capacity() const { return mask + 1; }
+
+    // Producer side
+    size_t freeSpace() const {
+        return capacity() - (writePos.load(std::memory_order_relaxed) - readPos.load(std::memory_order_acquire));
+    }
+
+    bool push(T const& value) {
+        size_t w = writePos.load(std::memory_order_relaxed);
+        if(w - readPos.load(std::memory_order_acquire) == capacity())
+            return false;
+        data[w & mask] = value;
+        writePos.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Either pushes all count values or none of them
+    bool push(T const* values, size_t count) {
+        size_t w = writePos.load(std::memory_order_relaxed);
+        if(capacity() - (w - readPos.load(std::memory_order_acquire)) < count)
+            return false;
+        for(size_t i = 0; i < count; i++)
+            data[(w + i) & mask] = values[i];
+        writePos.store(w + count, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& value) {
+        size_t r = readPos.load(std::memory_order_relaxed);
+        if(r == writePos.load(std::memory_order_acquire))
+            return false;
+        value = data[r & mask];
+        readPos.store(r + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pops exactly count values, the caller must know that they were pushed together
+    template <typename F>
+    void pop(size_t count, F&& consume) {
+        size_t r = readPos.load(std::memory_order_relaxed);
+        for(size_t i = 0; i < count; i++)
+            consume(data[(r + i) & mask]);
+        readPos.store(r + count, std::memory_order_release);
+    }
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+// Phases of GameWindowManager::StartupTimings
+enum class StartupPhase {
+    MANAGER_CREATION_START,
+    MANAGER_CREATED,
+    BACKEND_PROBE_START,
+    BACKEND_PROBED,
+    FIRST_WINDOW_CREATION_START,
+    FIRST_WINDOW_CREATED,
+    FIRST_CONTEXT_CURRENT,
+    FIRST_SWAP,
+    COUNT
+};
+
+// Keeps the first timestamp recorded for the phase, may be called from any thread
+void recordStartupPhase(StartupPhase phase, uint64_t timestamp);
+
+// Called by the implementations after createWindow succeeded
+void recordWindowCreated(uint64_t creationStart);
@@ -1,14 +1,22 @@
 #include "window_eglut.h"
 #include "joystick_manager_linux_gamepad.h"
+#include "game_window_metrics_collector.h"
 #include <game_window_manager.h>
 
 #include <cstring>
 #include <sstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
 #include <eglut.h>
 #define XK_MISCELLANY
 #define XK_LATIN1
 #define XK_XKB_KEYS
 #include <X11/keysymdef.h>
+// Xlib's KeyCode typedef collides with ours
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
 
 #define ShiftMask (1 << 0)
 #define LockMask (1 << 1)
@@ -23,7 +31,7 @@ EGLUTWindow* EGLUTWindow::currentWindow;
 
 EGLUTWindow::EGLUTWindow(const std::string& title, int width, int height, GraphicsApi api) : WindowWithLinuxJoystick(title, width, height, api), title(title), width(width), height(height), graphicsApi(api) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     eglutInitWindowSize(width, height);
     if(graphicsApi == GraphicsApi::OPENGL_ES2)
@@ -32,6 +40,8 @@ EGLUTWindow::EGLUTWindow(const std::string& title, int width, int height, Graphi
         eglutInitAPIMask(EGLUT_OPENGL_BIT);
 
     winId = eglutCreateWindow(title.c_str());
+    // eglut makes the context of a new window current
+    onContextCurrent();
 
     eglutIdleFunc(_eglutIdleFunc);
     eglutDisplayFunc(_eglutDisplayFunc);
@@ -48,13 +58,14 @@ EGLUTWindow::EGLUTWindow(const std::string& title, int width, int height, Graphi
     eglutPasteFunc(_eglutPasteFunc);
     eglutFocusFunc(_eglutFocusFunc);
     eglutCloseWindowFunc(_eglutCloseWindowFunc);
-
-    memset(pointerIds, 0xff, sizeof(pointerIds));
+    // Reported by the first poll like the other implementations
+    setSurface(width, height, width, height, 1.0f, 1.0f);
 }
 
 EGLUTWindow::~EGLUTWindow() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
+    std::lock_guard<X11Lock> lockPresent(presentLock);
 #endif
     if(currentWindow == this)
         currentWindow = nullptr;
@@ -64,21 +75,23 @@ EGLUTWindow::~EGLUTWindow() {
 
 void EGLUTWindow::setIcon(std::string const& iconPath) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     eglutSetWindowIcon(iconPath.c_str());
 }
 
 void EGLUTWindow::makeCurrent(bool active) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(presentLock);
 #endif
     eglutMakeCurrent(active ? winId : -1);
+    if(active)
+        onContextCurrent();
 }
 
 void EGLUTWindow::show() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     eglutShowWindow();
     currentWindow = this;
@@ -87,7 +100,8 @@ void EGLUTWindow::show() {
 
 void EGLUTWindow::close() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
+    std::lock_guard<X11Lock> lockPresent(presentLock);
 #endif
     currentWindow->onClose();
     int winId = currentWindow->winId;
@@ -98,10 +112,25 @@ void EGLUTWindow::close() {
 
 void EGLUTWindow::pollEvents() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     if(currentWindow->winId != -1) {
+        currentWindow->beginPollEvents();
         eglutPollEvents();
+        currentWindow->endPollEvents();
+    }
+}
+
+void EGLUTWindow::waitEvents(double timeout) {
+    // eglut has no blocking pump, poll until an event arrived or the timeout passed
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeout));
+    uint64_t events = getQueuedEventCount();
+    while(true) {
+        pollEvents();
+        auto now = std::chrono::steady_clock::now();
+        if(getQueuedEventCount() != events || currentWindow->winId == -1 || now >= deadline)
+            break;
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(deadline - now, std::chrono::milliseconds(2)));
     }
 }
 
@@ -111,7 +140,7 @@ bool EGLUTWindow::getCursorDisabled() {
 
 void EGLUTWindow::setCursorDisabled(bool disabled) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     if(!disabled && !getenv("GAMEWINDOW_CENTER_CURSOR")) {
         eglutWarpMousePointer(lastMouseX, lastMouseY);
@@ -126,7 +155,7 @@ bool EGLUTWindow::getFullscreen() {
 
 void EGLUTWindow::setFullscreen(bool fullscreen) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     if(eglutGet(EGLUT_FULLSCREEN_MODE) != (fullscreen ? EGLUT_FULLSCREEN : EGLUT_WINDOWED))
         eglutToggleFullscreen();
@@ -134,22 +163,70 @@ void EGLUTWindow::setFullscreen(bool fullscreen) {
 
 void EGLUTWindow::swapBuffers() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(presentLock);
 #endif
-    eglutSwapBuffers();
+    beginSwapBuffers();
+    {
+        GameWindowMetricsCollector::Timer timer(GameWindowMetricsCollector::HistogramId::SWAP_DURATION);
+        eglutSwapBuffers();
+    }
+    endSwapBuffers();
 }
 
 void EGLUTWindow::setSwapInterval(int interval) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(presentLock);
 #endif
+    // EGL clamps negative intervals to the minimum, usually 0, and has no adaptive vsync
+    if(interval < 0)
+        interval = 1;
     eglutSwapInterval(interval);
+    swapInterval = interval;
+}
+
+int EGLUTWindow::getSwapInterval() {
+    return swapInterval;
+}
+
+typedef EGLBoolean (*GetSyncValuesCHROMIUMFunc)(EGLDisplay display, EGLSurface surface, int64_t* ust, int64_t* msc, int64_t* sbc);
+
+bool EGLUTWindow::getPresentTiming(PresentTiming& timing) {
+    EGLDisplay display = eglGetCurrentDisplay();
+    EGLSurface surface = eglGetCurrentSurface(EGL_DRAW);
+    if(display == EGL_NO_DISPLAY || surface == EGL_NO_SURFACE)
+        return false;
+    static GetSyncValuesCHROMIUMFunc getSyncValues = [display]() -> GetSyncValuesCHROMIUMFunc {
+        const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+        if(extensions == nullptr || strstr(extensions, "EGL_CHROMIUM_sync_control") == nullptr)
+            return nullptr;
+        return (GetSyncValuesCHROMIUMFunc)eglGetProcAddress("eglGetSyncValuesCHROMIUM");
+    }();
+    int64_t ust, msc, sbc;
+    if(getSyncValues == nullptr || !getSyncValues(display, surface, &ust, &msc, &sbc))
+        return false;
+    // ust is in microseconds of CLOCK_MONOTONIC, the clock of steady_clock on linux
+    timing.vblankTimestamp = (uint64_t)ust * 1000;
+    timing.vblankCount = (uint64_t)msc;
+    timing.swapCount = (uint64_t)sbc;
+    return true;
 }
 
 void EGLUTWindow::_eglutIdleFunc() {
     if(currentWindow == nullptr)
         return;
     currentWindow->updateGamepad();
+    if(!currentWindow->isBackgroundThrottled()) {
+        currentWindow->backgroundRedisplayDeadline = 0;
+        eglutPostRedisplay();
+        return;
+    }
+    // Only one redisplay per background interval instead of a continuous one, the frame pacer in swapBuffers stays the throttle
+    uint64_t now = getTimestamp();
+    uint64_t& deadline = currentWindow->backgroundRedisplayDeadline;
+    if(now < deadline)
+        return;
+    uint64_t interval = (uint64_t)(1000000000.0 / currentWindow->getBackgroundFrameRate());
+    deadline = deadline == 0 || now > deadline + interval ? now + interval : deadline + interval;
     eglutPostRedisplay();
 }
 
@@ -160,9 +237,10 @@ void EGLUTWindow::_eglutDisplayFunc() {
 }
 
 void EGLUTWindow::_eglutReshapeFunc(int w, int h) {
-    if(currentWindow == nullptr || (currentWindow->width == w && currentWindow->height == h))
+    if(currentWindow == nullptr)
         return;
-    currentWindow->onWindowSizeChanged(w, h);
+    // eglut doesn't scale windows
+    currentWindow->setSurface(w, h, w, h, 1.0f, 1.0f);
     currentWindow->width = w;
     currentWindow->height = h;
 }
@@ -196,44 +274,22 @@ void EGLUTWindow::_eglutMouseButtonFunc(int x, int y, int btn, int action) {
     currentWindow->onMouseButton(x, y, btn, action == EGLUT_MOUSE_PRESS ? MouseButtonAction::PRESS : MouseButtonAction::RELEASE);
 }
 
-int EGLUTWindow::obtainTouchPointer(int eglutId) {
-    for(int i = 0; i < sizeof(pointerIds) / sizeof(int); i++) {
-        if(pointerIds[i] == eglutId)
-            return i;
-    }
-    for(int i = 0; i < sizeof(pointerIds) / sizeof(int); i++) {
-        if(pointerIds[i] == -1) {
-            pointerIds[i] = eglutId;
-            return i;
-        }
-    }
-    return sizeof(pointerIds) / sizeof(int) + eglutId;
-}
-
-void EGLUTWindow::releaseTouchPointer(int ourId) {
-    pointerIds[ourId] = -1;
-}
-
 void EGLUTWindow::_eglutTouchStartFunc(int id, double x, double y) {
     if(currentWindow == nullptr)
         return;
-    int ourId = currentWindow->obtainTouchPointer(id);
-    currentWindow->onTouchStart(ourId, x, y);
+    currentWindow->onNativeTouchStart(id, x, y);
 }
 
 void EGLUTWindow::_eglutTouchUpdateFunc(int id, double x, double y) {
     if(currentWindow == nullptr)
         return;
-    int ourId = currentWindow->obtainTouchPointer(id);
-    currentWindow->onTouchUpdate(ourId, x, y);
+    currentWindow->onNativeTouchUpdate(id, x, y);
 }
 
 void EGLUTWindow::_eglutTouchEndFunc(int id, double x, double y) {
     if(currentWindow == nullptr)
         return;
-    int ourId = currentWindow->obtainTouchPointer(id);
-    currentWindow->onTouchEnd(ourId, x, y);
-    currentWindow->releaseTouchPointer(ourId);
+    currentWindow->onNativeTouchEnd(id, x, y);
 }
 
 void EGLUTWindow::_eglutKeyboardFunc(char str[5], int action) {
@@ -244,9 +300,7 @@ void EGLUTWindow::_eglutKeyboardFunc(char str[5], int action) {
     if(action == EGLUT_KEY_PRESS || action == EGLUT_KEY_REPEAT) {
         if(str[0] == 13 && str[1] == 0)
             str[0] = 10;
-        std::stringstream ss;
-        ss << str;
-        currentWindow->onKeyboardText(ss.str());
+        currentWindow->onKeyboardText(std::string_view(str));
     }
 }
 
@@ -256,129 +310,77 @@ void EGLUTWindow::_eglutDropFunc(const char* path) {
     currentWindow->onDrop(path);
 }
 
-KeyCode EGLUTWindow::getKeyMinecraft(int keyCode) {
-    if(keyCode >= XK_A && keyCode <= XK_Z)
-        return (KeyCode)(keyCode - XK_A + (int)KeyCode::A);
-    if(keyCode >= XK_a && keyCode <= XK_z)
-        return (KeyCode)(keyCode - XK_a + (int)KeyCode::A);
-    if(keyCode >= XK_F1 && keyCode <= XK_F12)
-        return (KeyCode)(keyCode - XK_F1 + (int)KeyCode::FN1);
-    // if (keyCode >= XK_exclam && keyCode <= XK_parenleft)
-    //     return (KeyCode) (keyCode - XK_exclam + (int) KeyCode::NUM_1);
-    if(keyCode >= XK_KP_0 && keyCode <= XK_KP_9)
-        return (KeyCode)(keyCode - XK_KP_0 + (int)KeyCode::NUMPAD_0);
-    if(keyCode >= XK_KP_Multiply && keyCode <= XK_KP_Divide)
-        return (KeyCode)(keyCode - XK_KP_Multiply + (int)KeyCode::NUMPAD_MULTIPLY);
-    if(keyCode >= XK_KP_Home && keyCode <= XK_KP_Down)
-        return (KeyCode)(keyCode - XK_KP_Home + (int)KeyCode::HOME);
-    if(keyCode >= XK_KP_Prior && keyCode <= XK_KP_End)
-        return (KeyCode)(keyCode - XK_KP_Prior + (int)KeyCode::PAGE_UP);
-
-    switch(keyCode) {
-    case XK_exclam:
-        return KeyCode::NUM_1;
-    case XK_at:
-        return KeyCode::NUM_2;
-    case XK_numbersign:
-        return KeyCode::NUM_3;
-    case XK_dollar:
-        return KeyCode::NUM_4;
-    case XK_percent:
-        return KeyCode::NUM_5;
-    case XK_asciicircum:
-        return KeyCode::NUM_6;
-    case XK_ampersand:
-        return KeyCode::NUM_7;
-    case XK_asterisk:
-        return KeyCode::NUM_8;
-    case XK_parenleft:
-        return KeyCode::NUM_9;
-    case XK_parenright:
-        return KeyCode::NUM_0;
-    case XK_underscore:
-        return KeyCode::MINUS;
-    case XK_plus:
-        return KeyCode::EQUAL;
-
-    // case XK_parenright: return KeyCode::RIGHT_BRACKET;
-    case XK_BackSpace:
-        return KeyCode::BACKSPACE;
-    case XK_ISO_Left_Tab:
-    case XK_Tab:
-        return KeyCode::TAB;
-    case XK_Return:
-        return KeyCode::ENTER;
-    case XK_Shift_L:
-        return KeyCode::LEFT_SHIFT;
-    case XK_Shift_R:
-        return KeyCode::RIGHT_SHIFT;
-    case XK_Control_L:
-        return KeyCode::LEFT_CTRL;
-    case XK_Control_R:
-        return KeyCode::RIGHT_CTRL;
-    case XK_Pause:
-        return KeyCode::PAUSE;
-    case XK_Caps_Lock:
-        return KeyCode::CAPS_LOCK;
-    case XK_Escape:
-        return KeyCode::ESCAPE;
-    case XK_Page_Up:
-        return KeyCode::PAGE_UP;
-    case XK_Page_Down:
-        return KeyCode::PAGE_DOWN;
-    case XK_End:
-        return KeyCode::END;
-    case XK_Home:
-        return KeyCode::HOME;
-    case XK_Left:
-        return KeyCode::LEFT;
-    case XK_Up:
-        return KeyCode::UP;
-    case XK_Right:
-        return KeyCode::RIGHT;
-    case XK_Down:
-        return KeyCode::DOWN;
-    case XK_Insert:
-        return KeyCode::INSERT;
-    case XK_Delete:
-        return KeyCode::DELETE;
-    case XK_Num_Lock:
-        return KeyCode::NUM_LOCK;
-    case XK_Scroll_Lock:
-        return KeyCode::SCROLL_LOCK;
-    case XK_semicolon:
-        return KeyCode::SEMICOLON;
-    case XK_equal:
-        return KeyCode::EQUAL;
-    case XK_comma:
-        return KeyCode::COMMA;
-    case XK_minus:
-        return KeyCode::MINUS;
-    case XK_period:
-        return KeyCode::PERIOD;
-    case XK_slash:
-        return KeyCode::SLASH;
-    case XK_grave:
-        return KeyCode::GRAVE;
-    case XK_bracketleft:
-        return KeyCode::LEFT_BRACKET;
-    case XK_backslash:
-        return KeyCode::BACKSLASH;
-    case XK_bracketright:
-        return KeyCode::RIGHT_BRACKET;
-    case XK_apostrophe:
-        return KeyCode::APOSTROPHE;
-    case XK_Alt_L:
-        return KeyCode::LEFT_ALT;
-    case XK_Alt_R:
-        return KeyCode::RIGHT_ALT;
-    case XK_KP_Enter:
-        return KeyCode::ENTER;
-    }
+static constexpr NativeKeyMapping x11Latin1KeyMappings[] = {
+    mapKeys(XK_A, KeyCode::A, 26),
+    mapKeyAlias(XK_a, KeyCode::A, 26),
+    // Shifted number row
+    mapKeyAlias(XK_exclam, KeyCode::NUM_1),
+    mapKeyAlias(XK_at, KeyCode::NUM_2),
+    mapKeyAlias(XK_numbersign, KeyCode::NUM_3),
+    mapKeyAlias(XK_dollar, KeyCode::NUM_4),
+    mapKeyAlias(XK_percent, KeyCode::NUM_5),
+    mapKeyAlias(XK_asciicircum, KeyCode::NUM_6),
+    mapKeyAlias(XK_ampersand, KeyCode::NUM_7),
+    mapKeyAlias(XK_asterisk, KeyCode::NUM_8),
+    mapKeyAlias(XK_parenleft, KeyCode::NUM_9),
+    mapKeyAlias(XK_parenright, KeyCode::NUM_0),
+    mapKeyAlias(XK_underscore, KeyCode::MINUS),
+    mapKeyAlias(XK_plus, KeyCode::EQUAL),
+    mapKey(XK_semicolon, KeyCode::SEMICOLON),
+    mapKey(XK_equal, KeyCode::EQUAL),
+    mapKey(XK_comma, KeyCode::COMMA),
+    mapKey(XK_minus, KeyCode::MINUS),
+    mapKey(XK_period, KeyCode::PERIOD),
+    mapKey(XK_slash, KeyCode::SLASH),
+    mapKey(XK_grave, KeyCode::GRAVE),
+    mapKey(XK_bracketleft, KeyCode::LEFT_BRACKET),
+    mapKey(XK_backslash, KeyCode::BACKSLASH),
+    mapKey(XK_bracketright, KeyCode::RIGHT_BRACKET),
+    mapKey(XK_apostrophe, KeyCode::APOSTROPHE),
+};
+static constexpr NativeKeyMapping x11MiscKeyMappings[] = {
+    mapKeys(XK_F1, KeyCode::FN1, 12),
+    mapKeys(XK_KP_0, KeyCode::NUMPAD_0, 10),
+    mapKeys(XK_KP_Multiply, KeyCode::NUMPAD_MULTIPLY, XK_KP_Divide - XK_KP_Multiply + 1),
+    mapKeyAlias(XK_KP_Home, KeyCode::HOME, XK_KP_Down - XK_KP_Home + 1),
+    mapKeyAlias(XK_KP_Prior, KeyCode::PAGE_UP, XK_KP_End - XK_KP_Prior + 1),
+    mapKeyAlias(XK_KP_Enter, KeyCode::ENTER),
+    mapKey(XK_BackSpace, KeyCode::BACKSPACE),
+    mapKeyAlias(XK_ISO_Left_Tab, KeyCode::TAB),
+    mapKey(XK_Tab, KeyCode::TAB),
+    mapKey(XK_Return, KeyCode::ENTER),
+    mapKey(XK_Shift_L, KeyCode::LEFT_SHIFT),
+    mapKey(XK_Shift_R, KeyCode::RIGHT_SHIFT),
+    mapKey(XK_Control_L, KeyCode::LEFT_CTRL),
+    mapKey(XK_Control_R, KeyCode::RIGHT_CTRL),
+    mapKey(XK_Pause, KeyCode::PAUSE),
+    mapKey(XK_Caps_Lock, KeyCode::CAPS_LOCK),
+    mapKey(XK_Escape, KeyCode::ESCAPE),
+    mapKey(XK_Page_Up, KeyCode::PAGE_UP),
+    mapKey(XK_Page_Down, KeyCode::PAGE_DOWN),
+    mapKey(XK_End, KeyCode::END),
+    mapKey(XK_Home, KeyCode::HOME),
+    mapKey(XK_Left, KeyCode::LEFT),
+    mapKey(XK_Up, KeyCode::UP),
+    mapKey(XK_Right, KeyCode::RIGHT),
+    mapKey(XK_Down, KeyCode::DOWN),
+    mapKey(XK_Insert, KeyCode::INSERT),
+    mapKey(XK_Delete, KeyCode::DELETE),
+    mapKey(XK_Num_Lock, KeyCode::NUM_LOCK),
+    mapKey(XK_Scroll_Lock, KeyCode::SCROLL_LOCK),
+    mapKey(XK_Alt_L, KeyCode::LEFT_ALT),
+    mapKey(XK_Alt_R, KeyCode::RIGHT_ALT),
+};
+// Latin 1 keysyms without a mapping match the KeyCode values, the function keys are in 0xfe00 - 0xffff
+static constexpr NativeKeyTable<0, 0xff> x11Latin1Keys(x11Latin1KeyMappings, true);
+static constexpr NativeKeyTable<0xfe00, 0xffff> x11MiscKeys(x11MiscKeyMappings);
+static_assert(KeyCodeTable<0>(x11Latin1KeyMappings).isInverseOf(x11Latin1Keys), "Key mapped twice in x11Latin1KeyMappings");
+static_assert(KeyCodeTable<0>(x11MiscKeyMappings).isInverseOf(x11MiscKeys), "Key mapped twice in x11MiscKeyMappings");
 
-    if(keyCode < 256)
-        return (KeyCode)keyCode;
-    return KeyCode::UNKNOWN;
+KeyCode EGLUTWindow::getKeyMinecraft(int keyCode) {
+    if(keyCode <= 0xff)
+        return x11Latin1Keys[keyCode];
+    return x11MiscKeys[keyCode];
 }
 
 void EGLUTWindow::_eglutKeyboardSpecialFunc(int key, int action, unsigned int meta) {
@@ -403,13 +405,14 @@ void EGLUTWindow::_eglutKeyboardSpecialFunc(int key, int action, unsigned int me
 void EGLUTWindow::_eglutPasteFunc(const char* str, int len) {
     if(currentWindow == nullptr)
         return;
-    currentWindow->onPaste(std::string(str, len));
+    currentWindow->onPaste(std::string_view(str, len));
 }
 
 void EGLUTWindow::_eglutFocusFunc(int action) {
     if(currentWindow == nullptr)
         return;
     LinuxGamepadJoystickManager::instance.onWindowFocused(currentWindow, (action == EGLUT_FOCUSED));
+    currentWindow->onFocus(action == EGLUT_FOCUSED);
 }
 
 void EGLUTWindow::_eglutCloseWindowFunc() {
@@ -425,7 +428,7 @@ void EGLUTWindow::getWindowSize(int& width, int& height) const {
 
 void EGLUTWindow::setClipboardText(std::string const& text) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     eglutSetClipboardText(text.c_str());
 }
@@ -451,4 +454,92 @@ int EGLUTWindow::translateMeta(unsigned int meta) {
         mods |= KEY_MOD_NUMLOCK;
     }
     return mods;
-}
\ No newline at end of file
+}
+
+class EGLUTSharedContext : public GameWindowSharedContext {
+private:
+    EGLDisplay display;
+    EGLSurface surface;
+    EGLContext context;
+    EGLenum api;
+
+public:
+    EGLUTSharedContext(EGLDisplay display, EGLSurface surface, EGLContext context, EGLenum api) : display(display), surface(surface), context(context), api(api) {}
+
+    ~EGLUTSharedContext() override {
+        eglDestroyContext(display, context);
+        if(surface != EGL_NO_SURFACE)
+            eglDestroySurface(display, surface);
+    }
+
+    void makeCurrent(bool active) override {
+        eglBindAPI(api);
+        if(active)
+            eglMakeCurrent(display, surface, surface, context);
+        else
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+};
+
+std::shared_ptr<GameWindowSharedContext> EGLUTWindow::createSharedContext() {
+#ifdef GAMEWINDOW_X11_LOCK
+    std::lock_guard<X11Lock> lock(presentLock);
+#endif
+    // eglut doesn't expose its context, query it while the window is current
+    EGLDisplay prevDisplay = eglGetCurrentDisplay();
+    EGLContext prevContext = eglGetCurrentContext();
+    EGLSurface prevDraw = eglGetCurrentSurface(EGL_DRAW);
+    EGLSurface prevRead = eglGetCurrentSurface(EGL_READ);
+    eglutMakeCurrent(winId);
+    EGLDisplay display = eglGetCurrentDisplay();
+    EGLContext share = eglGetCurrentContext();
+
+    EGLint configId = 0, clientType = EGL_OPENGL_ES_API, clientVersion = 2;
+    eglQueryContext(display, share, EGL_CONFIG_ID, &configId);
+    eglQueryContext(display, share, EGL_CONTEXT_CLIENT_TYPE, &clientType);
+    eglQueryContext(display, share, EGL_CONTEXT_CLIENT_VERSION, &clientVersion);
+    EGLint configAttribs[] = {EGL_CONFIG_ID, configId, EGL_NONE};
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;
+    if(eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) && numConfigs > 0) {
+        EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, clientVersion, EGL_NONE};
+        eglBindAPI(clientType);
+        context = eglCreateContext(display, config, share, clientType == EGL_OPENGL_ES_API ? contextAttribs : nullptr);
+        // Without pbuffer support of the config the context is used surfaceless
+        EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        if(context != EGL_NO_CONTEXT)
+            surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+    }
+    EGLint error = eglGetError();
+
+    if(prevContext != EGL_NO_CONTEXT)
+        eglMakeCurrent(prevDisplay, prevDraw, prevRead, prevContext);
+    else
+        eglutMakeCurrent(-1);
+
+    if(context == EGL_NO_CONTEXT) {
+        std::stringstream errormsg;
+        errormsg << "eglCreateContext failed with error 0x" << std::hex << error;
+        GameWindowManager::getManager()->getErrorHandler()->onError("EGLUT Shared Context", errormsg.str());
+        return nullptr;
+    }
+    return std::make_shared<EGLUTSharedContext>(display, surface, context, (EGLenum)clientType);
+}
+
+GameWindow::LockWaitStats EGLUTWindow::getEventLockWaitStats() {
+#ifdef GAMEWINDOW_X11_LOCK
+    return eventLock.getStats();
+#else
+    return {};
+#endif
+}
+
+GameWindow::LockWaitStats EGLUTWindow::getPresentLockWaitStats() {
+#ifdef GAMEWINDOW_X11_LOCK
+    return presentLock.getStats();
+#else
+    return {};
+#endif
+}
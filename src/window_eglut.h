@@ -5,7 +5,7 @@
 
 #include "window_with_linux_gamepad.h"
 
-#include <mutex>
+#include "x11_lock.h"
 
 class EGLUTWindow : public WindowWithLinuxJoystick {
 private:
@@ -16,12 +16,15 @@ private:
     GraphicsApi graphicsApi;
     int winId = -1;
     bool cursorDisabled = false;
+    int swapInterval = 0;
     bool moveMouseToCenter = false;
     int lastMouseX = -1, lastMouseY = -1;
-    int pointerIds[16];
+    // Next redisplay while throttled in the background, 0 while in the foreground
+    uint64_t backgroundRedisplayDeadline = 0;
 
 #ifdef GAMEWINDOW_X11_LOCK
-    std::recursive_mutex x11_sync;
+    // A vsync blocked present must not stall event pumping on another thread
+    X11Lock eventLock, presentLock;
 #endif
 
     static KeyCode getKeyMinecraft(int keyCode);
@@ -42,8 +45,6 @@ private:
     static void _eglutFocusFunc(int action);
     static void _eglutCloseWindowFunc();
 
-    int obtainTouchPointer(int eglutId);
-    void releaseTouchPointer(int ourId);
     static int translateMeta(unsigned int meta);
 
 public:
@@ -59,8 +60,12 @@ public:
 
     void close() override;
 
+    using GameWindow::pollEvents;
+
     void pollEvents() override;
 
+    void waitEvents(double timeout) override;
+
     bool getCursorDisabled() override;
 
     void setCursorDisabled(bool disabled) override;
@@ -76,4 +81,14 @@ public:
     void swapBuffers() override;
 
     void setSwapInterval(int interval) override;
+
+    int getSwapInterval() override;
+
+    bool getPresentTiming(PresentTiming& timing) override;
+
+    std::shared_ptr<GameWindowSharedContext> createSharedContext() override;
+
+    LockWaitStats getEventLockWaitStats() override;
+
+    LockWaitStats getPresentLockWaitStats() override;
 };
@@ -1,17 +1,16 @@
 #include "window_glfw.h"
 #include "game_window_manager.h"
 #include "joystick_manager_glfw.h"
+#include "game_window_metrics_collector.h"
 
-#include <codecvt>
 #include <iomanip>
 #include <thread>
-#include <sstream>
 
 #include <math.h>
 
 GLFWGameWindow::GLFWGameWindow(const std::string& title, int width, int height, GraphicsApi api) : GameWindow(title, width, height, api), width(width), height(height), windowedWidth(width), windowedHeight(height) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     glfwDefaultWindowHints();
     if(api == GraphicsApi::OPENGL_ES2) {
@@ -52,26 +51,40 @@ GLFWGameWindow::GLFWGameWindow(const std::string& title, int width, int height,
     glfwSetDropCallback(window, _glfwDropCallback);
     glfwSetWindowFocusCallback(window, _glfwWindowFocusCallback);
     glfwSetWindowContentScaleCallback(window, _glfwWindowContentScaleCallback);
+    glfwSetWindowIconifyCallback(window, _glfwWindowIconifyCallback);
+    glfwSetMonitorCallback(_glfwMonitorCallback);
     glfwMakeContextCurrent(window);
+    onContextCurrent();
 
     setRelativeScale();
 
-    lastFrame = std::chrono::system_clock::now();
+#ifdef GLFW_PLATFORM_X11
+    asyncClipboard = glfwGetPlatform() == GLFW_PLATFORM_X11;
+#elif !defined(__APPLE__) && !defined(_WIN32)
+    // GLFW before 3.4 has a single platform, X11 unless it was built for wayland
+    asyncClipboard = getenv("WAYLAND_DISPLAY") == nullptr;
+#endif
+
+    lastFrame = std::chrono::steady_clock::now();
 }
 
 void GLFWGameWindow::makeCurrent(bool c) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(presentLock);
 #endif
     glfwMakeContextCurrent(c ? window : nullptr);
+    if(c)
+        onContextCurrent();
 }
 
 GLFWGameWindow::~GLFWGameWindow() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
+    std::lock_guard<X11Lock> lockPresent(presentLock);
 #endif
     GLFWJoystickManager::removeWindow(this);
     glfwDestroyWindow(window);
+    GLFWSharedContext::destroyRetired();
 }
 
 void GLFWGameWindow::setIcon(std::string const& iconPath) {
@@ -80,7 +93,7 @@ void GLFWGameWindow::setIcon(std::string const& iconPath) {
 
 void GLFWGameWindow::setRelativeScale() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     int fx, fy;
     glfwGetFramebufferSize(window, &fx, &fy);
@@ -92,9 +105,18 @@ void GLFWGameWindow::setRelativeScale() {
     // Update window size to match content size mismatch
     width = fx;
     height = fy;
+    setDrawableSize(width, height);
     resized = true;
 }
 
+void GLFWGameWindow::updateSurface() {
+    int wx, wy;
+    glfwGetWindowSize(window, &wx, &wy);
+    float sx, sy;
+    glfwGetWindowContentScale(window, &sx, &sy);
+    setSurface(width, height, wx, wy, sx, sy);
+}
+
 double GLFWGameWindow::getRelativeScale() const {
     return relativeScale;
 }
@@ -106,7 +128,7 @@ void GLFWGameWindow::getWindowSize(int& width, int& height) const {
 
 void GLFWGameWindow::show() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     GLFWJoystickManager::addWindow(this);
     glfwShowWindow(window);
@@ -114,21 +136,40 @@ void GLFWGameWindow::show() {
 
 void GLFWGameWindow::close() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     onClose();
     glfwSetWindowShouldClose(window, GLFW_TRUE);
 }
 
-static std::string getModeDescription(const GLFWvidmode& mode) {
-    std::stringstream desc;
-    desc << mode.width << "x" << mode.height << " @ " << mode.refreshRate;
-    return desc.str();
+DisplayModeIndex<GLFWmonitor*, GLFWvidmode> GLFWGameWindow::modeIndex;
+
+std::vector<FullscreenMode> const& GLFWGameWindow::getMonitorModes(GLFWmonitor* monitor) {
+    return modeIndex.getModes(monitor, [monitor](std::vector<GLFWvidmode>& nativeModes) {
+        int nModes = 0;
+        auto modes = monitor != nullptr ? glfwGetVideoModes(monitor, &nModes) : nullptr;
+        if(modes != nullptr)
+            nativeModes.assign(modes, modes + nModes);
+    }, [](const GLFWvidmode& mode) {
+        return FullscreenMode{.width = mode.width, .height = mode.height, .refreshRate = (double)mode.refreshRate};
+    });
+}
+
+void GLFWGameWindow::_glfwMonitorCallback(GLFWmonitor* monitor, int event) {
+    modeIndex.invalidate();
 }
 
 void GLFWGameWindow::pollEvents() {
+    pumpEvents(-1.0);
+}
+
+void GLFWGameWindow::waitEvents(double timeout) {
+    pumpEvents(timeout);
+}
+
+void GLFWGameWindow::pumpEvents(double timeout) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     if((glfwGetWindowMonitor(window) != NULL) != requestFullscreen) {
         if(requestFullscreen) {
@@ -137,10 +178,9 @@ void GLFWGameWindow::pollEvents() {
             windowedWidth = (int)floor(width / getRelativeScale());
             windowedHeight = (int)floor(height / getRelativeScale());
             GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-            int nModes = 0;
-            auto modes = glfwGetVideoModes(monitor, &nModes);
-            if(mode.id != -1 && nModes > mode.id && mode.description == getModeDescription(modes[mode.id])) {
-                glfwSetWindowMonitor(window, monitor, 0, 0, modes[mode.id].width, modes[mode.id].height, modes[mode.id].refreshRate);
+            getMonitorModes(monitor);
+            if(auto nativeMode = modeIndex.findNativeMode(monitor, mode)) {
+                glfwSetWindowMonitor(window, monitor, 0, 0, nativeMode->width, nativeMode->height, nativeMode->refreshRate);
                 return;
             }
             const GLFWvidmode* mode = glfwGetVideoMode(monitor);
@@ -150,21 +190,34 @@ void GLFWGameWindow::pollEvents() {
         }
     } else if(pendingFullscreenModeSwitch) {
         pendingFullscreenModeSwitch = false;
-        int nModes = 0;
         auto display = glfwGetWindowMonitor(window);
         if(display) {
-            auto modes = glfwGetVideoModes(display, &nModes);
-            if(mode.id != -1 && nModes > mode.id && mode.description == getModeDescription(modes[mode.id])) {
-                glfwSetWindowMonitor(window, display, 0, 0, modes[mode.id].width, modes[mode.id].height, modes[mode.id].refreshRate);
-            }
+            getMonitorModes(display);
+            if(auto nativeMode = modeIndex.findNativeMode(display, mode))
+                glfwSetWindowMonitor(window, display, 0, 0, nativeMode->width, nativeMode->height, nativeMode->refreshRate);
         }
     }
-    glfwPollEvents();
+    beginPollEvents();
+    // Gamepads are polled below and don't wake up the wait
+    if(timeout < 0.0)
+        glfwPollEvents();
+    else
+        glfwWaitEventsTimeout(timeout);
+    GLFWSharedContext::destroyRetired();
     if(resized) {
-        onWindowSizeChanged(width, height);
         resized = false;
+        updateSurface();
     }
     GLFWJoystickManager::update(this);
+    if(takePasteRequest() && !(asyncClipboard && clipboardReader.request())) {
+        auto clipboardString = glfwGetClipboardString(window);
+        if(clipboardString != nullptr)
+            onPaste(clipboardString);
+    }
+    std::string pasted;
+    if(clipboardReader.take(pasted))
+        onPaste(pasted);
+    endPollEvents();
 }
 
 bool GLFWGameWindow::getCursorDisabled() {
@@ -173,7 +226,7 @@ bool GLFWGameWindow::getCursorDisabled() {
 
 void GLFWGameWindow::setCursorDisabled(bool disabled) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     if(disabled) {
         if(glfwRawMouseMotionSupported())
@@ -197,52 +250,73 @@ void GLFWGameWindow::setFullscreen(bool fullscreen) {
     // Bug macOS fullscreen doesn't work correctly on newer macOS
     // Ignore Fullscreen starting from now
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     requestFullscreen = fullscreen;
 }
 
 void GLFWGameWindow::setClipboardText(std::string const& text) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(eventLock);
 #endif
     glfwSetClipboardString(window, text.c_str());
 }
 
 void GLFWGameWindow::swapBuffers() {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(presentLock);
 #endif
+    beginSwapBuffers();
+    {
+        GameWindowMetricsCollector::Timer timer(GameWindowMetricsCollector::HistogramId::SWAP_DURATION);
 #ifdef __APPLE__
-    if(swapInterval > 0 && brokenVSync) {
-        std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> waitTime = lastFrame + swapInterval * std::chrono::nanoseconds(1000000000 / 120);
-        lastFrame = std::chrono::system_clock::now();
-        glfwSwapBuffers(window);
-        std::this_thread::sleep_for(waitTime - lastFrame);
-    } else if(swapInterval > 0 && checkBrokenVSync >= 0) {
-        glfwSwapBuffers(window);
-        if(lastFrame + std::chrono::seconds(5) < std::chrono::system_clock::now()) {
-            checkBrokenVSync = -1;
-        } else {
-            checkBrokenVSync++;
-            if(checkBrokenVSync > 256 * 5) {
-                brokenVSync = true;
+        if(swapInterval > 0 && checkBrokenVSync >= 0) {
+            glfwSwapBuffers(window);
+            if(lastFrame + std::chrono::seconds(5) < std::chrono::steady_clock::now()) {
+                checkBrokenVSync = -1;
+            } else {
+                checkBrokenVSync++;
+                if(checkBrokenVSync > 256 * 5) {
+                    // Newer macOS ignores the swap interval, let the frame pacer wait instead
+                    checkBrokenVSync = -1;
+                    brokenVSync = true;
+                    setSwapIntervalEmulation(swapInterval);
+                }
             }
-        }
-    } else {
+        } else {
 #endif
-        glfwSwapBuffers(window);
+            glfwSwapBuffers(window);
 #ifdef __APPLE__
-    }
+        }
 #endif
+    }
+    endSwapBuffers();
 }
 
 void GLFWGameWindow::setSwapInterval(int interval) {
 #ifdef GAMEWINDOW_X11_LOCK
-    std::lock_guard<std::recursive_mutex> lock(x11_sync);
+    std::lock_guard<X11Lock> lock(presentLock);
 #endif
+    // Adaptive vsync requires the swap_control_tear extension of the context's platform
+    if(interval < 0 && !glfwExtensionSupported("GLX_EXT_swap_control_tear") && !glfwExtensionSupported("WGL_EXT_swap_control_tear") && !glfwExtensionSupported("EGL_EXT_swap_control_tear"))
+        interval = 1;
     glfwSwapInterval(interval);
     swapInterval = interval;
+    if(brokenVSync)
+        setSwapIntervalEmulation(interval);
+}
+
+int GLFWGameWindow::getSwapInterval() {
+    return swapInterval;
+}
+
+double GLFWGameWindow::getDisplayRefreshRate() {
+    // GLFW doesn't know the monitor of windowed windows
+    GLFWmonitor* monitor = glfwGetWindowMonitor(window);
+    if(monitor == nullptr)
+        monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode = monitor != nullptr ? glfwGetVideoMode(monitor) : nullptr;
+    return mode != nullptr ? mode->refreshRate : 0.0;
 }
 
 void GLFWGameWindow::_glfwWindowSizeCallback(GLFWwindow* window, int w, int h) {
@@ -288,104 +362,59 @@ void GLFWGameWindow::_glfwScrollCallback(GLFWwindow* window, double x, double y)
     user->onMouseScroll(cx, cy, x, y);
 }
 
+static constexpr NativeKeyMapping glfwKeyMappings[] = {
+    mapKeys(GLFW_KEY_F1, KeyCode::FN1, 12),
+    mapKeys(GLFW_KEY_KP_0, KeyCode::NUMPAD_0, 10),
+    mapKey(GLFW_KEY_BACKSPACE, KeyCode::BACKSPACE),
+    mapKey(GLFW_KEY_TAB, KeyCode::TAB),
+    mapKey(GLFW_KEY_ENTER, KeyCode::ENTER),
+    mapKey(GLFW_KEY_LEFT_SHIFT, KeyCode::LEFT_SHIFT),
+    mapKey(GLFW_KEY_RIGHT_SHIFT, KeyCode::RIGHT_SHIFT),
+    mapKey(GLFW_KEY_LEFT_CONTROL, KeyCode::LEFT_CTRL),
+    mapKey(GLFW_KEY_RIGHT_CONTROL, KeyCode::RIGHT_CTRL),
+    mapKey(GLFW_KEY_PAUSE, KeyCode::PAUSE),
+    mapKey(GLFW_KEY_CAPS_LOCK, KeyCode::CAPS_LOCK),
+    mapKey(GLFW_KEY_ESCAPE, KeyCode::ESCAPE),
+    mapKey(GLFW_KEY_PAGE_UP, KeyCode::PAGE_UP),
+    mapKey(GLFW_KEY_PAGE_DOWN, KeyCode::PAGE_DOWN),
+    mapKey(GLFW_KEY_END, KeyCode::END),
+    mapKey(GLFW_KEY_HOME, KeyCode::HOME),
+    mapKey(GLFW_KEY_LEFT, KeyCode::LEFT),
+    mapKey(GLFW_KEY_UP, KeyCode::UP),
+    mapKey(GLFW_KEY_RIGHT, KeyCode::RIGHT),
+    mapKey(GLFW_KEY_DOWN, KeyCode::DOWN),
+    mapKey(GLFW_KEY_INSERT, KeyCode::INSERT),
+    mapKey(GLFW_KEY_DELETE, KeyCode::DELETE),
+    mapKey(GLFW_KEY_NUM_LOCK, KeyCode::NUM_LOCK),
+    mapKey(GLFW_KEY_SCROLL_LOCK, KeyCode::SCROLL_LOCK),
+    mapKey(GLFW_KEY_SEMICOLON, KeyCode::SEMICOLON),
+    mapKey(GLFW_KEY_EQUAL, KeyCode::EQUAL),
+    mapKey(GLFW_KEY_COMMA, KeyCode::COMMA),
+    mapKey(GLFW_KEY_MINUS, KeyCode::MINUS),
+    mapKey(GLFW_KEY_PERIOD, KeyCode::PERIOD),
+    mapKey(GLFW_KEY_SLASH, KeyCode::SLASH),
+    mapKey(GLFW_KEY_GRAVE_ACCENT, KeyCode::GRAVE),
+    mapKey(GLFW_KEY_LEFT_BRACKET, KeyCode::LEFT_BRACKET),
+    mapKey(GLFW_KEY_BACKSLASH, KeyCode::BACKSLASH),
+    mapKey(GLFW_KEY_RIGHT_BRACKET, KeyCode::RIGHT_BRACKET),
+    mapKey(GLFW_KEY_APOSTROPHE, KeyCode::APOSTROPHE),
+    mapKey(GLFW_KEY_LEFT_SUPER, KeyCode::LEFT_SUPER),
+    mapKey(GLFW_KEY_RIGHT_SUPER, KeyCode::RIGHT_SUPER),
+    mapKey(GLFW_KEY_LEFT_ALT, KeyCode::LEFT_ALT),
+    mapKey(GLFW_KEY_RIGHT_ALT, KeyCode::RIGHT_ALT),
+    mapKeyAlias(GLFW_KEY_KP_ENTER, KeyCode::ENTER),
+    mapKey(GLFW_KEY_KP_SUBTRACT, KeyCode::NUMPAD_SUBTRACT),
+    mapKey(GLFW_KEY_KP_MULTIPLY, KeyCode::NUMPAD_MULTIPLY),
+    mapKey(GLFW_KEY_KP_ADD, KeyCode::NUMPAD_ADD),
+    mapKey(GLFW_KEY_KP_DIVIDE, KeyCode::NUMPAD_DIVIDE),
+    mapKey(GLFW_KEY_KP_DECIMAL, KeyCode::NUMPAD_DECIMAL),
+};
+// Printable keys match the KeyCode values
+static constexpr NativeKeyTable<0, GLFW_KEY_LAST> glfwKeys(glfwKeyMappings, true);
+static_assert(KeyCodeTable<GLFW_KEY_UNKNOWN>(glfwKeyMappings).isInverseOf(glfwKeys), "Key mapped twice in glfwKeyMappings");
+
 KeyCode GLFWGameWindow::getKeyMinecraft(int keyCode) {
-    if(keyCode >= GLFW_KEY_F1 && keyCode <= GLFW_KEY_F12)
-        return (KeyCode)(keyCode - GLFW_KEY_F1 + (int)KeyCode::FN1);
-    if(keyCode >= GLFW_KEY_KP_0 && keyCode <= GLFW_KEY_KP_9)
-        return (KeyCode)(keyCode - GLFW_KEY_KP_0 + (int)KeyCode::NUMPAD_0);
-    switch(keyCode) {
-    case GLFW_KEY_BACKSPACE:
-        return KeyCode::BACKSPACE;
-    case GLFW_KEY_TAB:
-        return KeyCode::TAB;
-    case GLFW_KEY_ENTER:
-        return KeyCode::ENTER;
-    case GLFW_KEY_LEFT_SHIFT:
-        return KeyCode::LEFT_SHIFT;
-    case GLFW_KEY_RIGHT_SHIFT:
-        return KeyCode::RIGHT_SHIFT;
-    case GLFW_KEY_LEFT_CONTROL:
-        return KeyCode::LEFT_CTRL;
-    case GLFW_KEY_RIGHT_CONTROL:
-        return KeyCode::RIGHT_CTRL;
-    case GLFW_KEY_PAUSE:
-        return KeyCode::PAUSE;
-    case GLFW_KEY_CAPS_LOCK:
-        return KeyCode::CAPS_LOCK;
-    case GLFW_KEY_ESCAPE:
-        return KeyCode::ESCAPE;
-    case GLFW_KEY_PAGE_UP:
-        return KeyCode::PAGE_UP;
-    case GLFW_KEY_PAGE_DOWN:
-        return KeyCode::PAGE_DOWN;
-    case GLFW_KEY_END:
-        return KeyCode::END;
-    case GLFW_KEY_HOME:
-        return KeyCode::HOME;
-    case GLFW_KEY_LEFT:
-        return KeyCode::LEFT;
-    case GLFW_KEY_UP:
-        return KeyCode::UP;
-    case GLFW_KEY_RIGHT:
-        return KeyCode::RIGHT;
-    case GLFW_KEY_DOWN:
-        return KeyCode::DOWN;
-    case GLFW_KEY_INSERT:
-        return KeyCode::INSERT;
-    case GLFW_KEY_DELETE:
-        return KeyCode::DELETE;
-    case GLFW_KEY_NUM_LOCK:
-        return KeyCode::NUM_LOCK;
-    case GLFW_KEY_SCROLL_LOCK:
-        return KeyCode::SCROLL_LOCK;
-    case GLFW_KEY_SEMICOLON:
-        return KeyCode::SEMICOLON;
-    case GLFW_KEY_EQUAL:
-        return KeyCode::EQUAL;
-    case GLFW_KEY_COMMA:
-        return KeyCode::COMMA;
-    case GLFW_KEY_MINUS:
-        return KeyCode::MINUS;
-    case GLFW_KEY_PERIOD:
-        return KeyCode::PERIOD;
-    case GLFW_KEY_SLASH:
-        return KeyCode::SLASH;
-    case GLFW_KEY_GRAVE_ACCENT:
-        return KeyCode::GRAVE;
-    case GLFW_KEY_LEFT_BRACKET:
-        return KeyCode::LEFT_BRACKET;
-    case GLFW_KEY_BACKSLASH:
-        return KeyCode::BACKSLASH;
-    case GLFW_KEY_RIGHT_BRACKET:
-        return KeyCode::RIGHT_BRACKET;
-    case GLFW_KEY_APOSTROPHE:
-        return KeyCode::APOSTROPHE;
-
-    case GLFW_KEY_LEFT_SUPER:
-        return KeyCode::LEFT_SUPER;
-    case GLFW_KEY_RIGHT_SUPER:
-        return KeyCode::RIGHT_SUPER;
-    case GLFW_KEY_LEFT_ALT:
-        return KeyCode::LEFT_ALT;
-    case GLFW_KEY_RIGHT_ALT:
-        return KeyCode::RIGHT_ALT;
-
-    case GLFW_KEY_KP_ENTER:
-        return KeyCode::ENTER;
-    case GLFW_KEY_KP_SUBTRACT:
-        return KeyCode::NUMPAD_SUBTRACT;
-    case GLFW_KEY_KP_MULTIPLY:
-        return KeyCode::NUMPAD_MULTIPLY;
-    case GLFW_KEY_KP_ADD:
-        return KeyCode::NUMPAD_ADD;
-    case GLFW_KEY_KP_DIVIDE:
-        return KeyCode::NUMPAD_DIVIDE;
-    case GLFW_KEY_KP_DECIMAL:
-        return KeyCode::NUMPAD_DECIMAL;
-    }
-    if(keyCode < 256)
-        return (KeyCode)keyCode;
-    return KeyCode::UNKNOWN;
+    return glfwKeys[keyCode];
 }
 
 void GLFWGameWindow::_glfwKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
@@ -409,9 +438,7 @@ void GLFWGameWindow::_glfwKeyCallback(GLFWwindow* window, int key, int scancode,
 #else
     if(action == GLFW_PRESS && mods & GLFW_MOD_CONTROL && key == GLFW_KEY_V) {
 #endif
-        auto clipboardString = glfwGetClipboardString(window);
-        if(clipboardString != nullptr)
-            user->onPaste(clipboardString);
+        user->requestPaste();
     }
 #ifndef NDEBUG
     else {
@@ -426,8 +453,7 @@ void GLFWGameWindow::_glfwKeyCallback(GLFWwindow* window, int key, int scancode,
 
 void GLFWGameWindow::_glfwCharCallback(GLFWwindow* window, unsigned int ch) {
     GLFWGameWindow* user = (GLFWGameWindow*)glfwGetWindowUserPointer(window);
-    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> cvt;
-    user->onKeyboardText(cvt.to_bytes(ch));
+    user->onKeyboardText((char32_t)ch);
 }
 
 void GLFWGameWindow::_glfwDropCallback(GLFWwindow* window, int count, const char** paths) {
@@ -447,6 +473,12 @@ void GLFWGameWindow::_glfwWindowFocusCallback(GLFWwindow* window, int focused) {
     GLFWGameWindow* user = (GLFWGameWindow*)glfwGetWindowUserPointer(window);
     GLFWJoystickManager::onWindowFocused(user, focused == GLFW_TRUE);
     user->focused = (focused == GLFW_TRUE);
+    user->onFocus(user->focused);
+}
+
+void GLFWGameWindow::_glfwWindowIconifyCallback(GLFWwindow* window, int iconified) {
+    GLFWGameWindow* user = (GLFWGameWindow*)glfwGetWindowUserPointer(window);
+    user->onVisibility(iconified != GLFW_TRUE);
 }
 
 void GLFWGameWindow::_glfwWindowContentScaleCallback(GLFWwindow* window, float scalex, float scaley) {
@@ -459,29 +491,24 @@ void GLFWGameWindow::setFullscreenMode(const FullscreenMode& mode) {
     pendingFullscreenModeSwitch = true;
 }
 
-std::vector<FullscreenMode> GLFWGameWindow::getFullscreenModes() {
-    if(modes.empty()) {
-        int nModes = 0;
-        auto display = glfwGetPrimaryMonitor();
-        auto modes = glfwGetVideoModes(display, &nModes);
-        for(int j = 0; j < nModes; j++) {
-            this->modes.emplace_back(FullscreenMode{.id = j, .description = getModeDescription(modes[j])});
-        }
-    }
-    return modes;
+// Windowed windows enter fullscreen on the primary monitor
+GLFWmonitor* GLFWGameWindow::getModeMonitor() {
+    GLFWmonitor* monitor = glfwGetWindowMonitor(window);
+    return monitor != nullptr ? monitor : glfwGetPrimaryMonitor();
+}
+
+std::vector<FullscreenMode> const& GLFWGameWindow::getFullscreenModes() {
+    return getMonitorModes(getModeMonitor());
 }
 
 FullscreenMode GLFWGameWindow::getFullscreenMode() {
-    auto display = glfwGetPrimaryMonitor();
-    int nModes;
-    auto modes = glfwGetVideoModes(display, &nModes);
-    auto mode = glfwGetVideoMode(display);
-    if(mode && modes) {
-        auto desc = getModeDescription(*mode);
-        for(int i = 0; i < nModes; i++) {
-            if(desc == getModeDescription(modes[i])) {
-                return FullscreenMode{.id = i, .description = desc};
-            }
+    auto display = getModeMonitor();
+    auto& modes = getMonitorModes(display);
+    auto mode = display != nullptr ? glfwGetVideoMode(display) : nullptr;
+    if(mode) {
+        for(auto& m : modes) {
+            if(m.width == mode->width && m.height == mode->height && m.refreshRate == (double)mode->refreshRate)
+                return m;
         }
     }
     return FullscreenMode{-1};
@@ -508,4 +535,71 @@ int GLFWGameWindow::translateMeta(unsigned int meta) {
         mods |= KEY_MOD_NUMLOCK;
     }
     return mods;
-}
\ No newline at end of file
+}
+
+std::shared_ptr<GameWindowSharedContext> GLFWGameWindow::createSharedContext() {
+#ifdef GAMEWINDOW_X11_LOCK
+    std::lock_guard<X11Lock> lock(eventLock);
+#endif
+    // Mirror the context of the window, otherwise GLFW refuses to share objects with it
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CLIENT_API, glfwGetWindowAttrib(window, GLFW_CLIENT_API));
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, glfwGetWindowAttrib(window, GLFW_CONTEXT_CREATION_API));
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, glfwGetWindowAttrib(window, GLFW_CONTEXT_VERSION_MAJOR));
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, glfwGetWindowAttrib(window, GLFW_CONTEXT_VERSION_MINOR));
+    if(glfwGetWindowAttrib(window, GLFW_CLIENT_API) == GLFW_OPENGL_API) {
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, glfwGetWindowAttrib(window, GLFW_OPENGL_FORWARD_COMPAT));
+        glfwWindowHint(GLFW_OPENGL_PROFILE, glfwGetWindowAttrib(window, GLFW_OPENGL_PROFILE));
+    }
+    GLFWwindow* shared = glfwCreateWindow(1, 1, "", nullptr, window);
+    glfwDefaultWindowHints();
+    if(shared == nullptr) {
+        const char* error = nullptr;
+        glfwGetError(&error);
+        GameWindowManager::getManager()->getErrorHandler()->onError("GLFW Shared Context", error == nullptr ? "GLFW failed to create a shared context without any error message" : error);
+        return nullptr;
+    }
+    return std::make_shared<GLFWSharedContext>(shared);
+}
+
+std::mutex GLFWSharedContext::retiredLock;
+std::vector<GLFWwindow*> GLFWSharedContext::retired;
+
+GLFWSharedContext::~GLFWSharedContext() {
+    // The last reference is usually dropped on the worker, which may still have the context current
+    if(glfwGetCurrentContext() == window)
+        glfwMakeContextCurrent(nullptr);
+    std::lock_guard<std::mutex> lock(retiredLock);
+    retired.push_back(window);
+}
+
+void GLFWSharedContext::destroyRetired() {
+    std::vector<GLFWwindow*> windows;
+    {
+        std::lock_guard<std::mutex> lock(retiredLock);
+        windows.swap(retired);
+    }
+    for(auto window : windows)
+        glfwDestroyWindow(window);
+}
+
+void GLFWSharedContext::makeCurrent(bool active) {
+    glfwMakeContextCurrent(active ? window : nullptr);
+}
+
+GameWindow::LockWaitStats GLFWGameWindow::getEventLockWaitStats() {
+#ifdef GAMEWINDOW_X11_LOCK
+    return eventLock.getStats();
+#else
+    return {};
+#endif
+}
+
+GameWindow::LockWaitStats GLFWGameWindow::getPresentLockWaitStats() {
+#ifdef GAMEWINDOW_X11_LOCK
+    return presentLock.getStats();
+#else
+    return {};
+#endif
+}
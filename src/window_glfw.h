@@ -5,8 +5,31 @@
 
 #include <game_window.h>
 #include <GLFW/glfw3.h>
-#include <mutex>
+#include "x11_lock.h"
+#include "display_mode_index.h"
+#include "x11_clipboard_reader.h"
 #include <chrono>
+#include <mutex>
+#include <vector>
+
+class GLFWSharedContext : public GameWindowSharedContext {
+private:
+    GLFWwindow* window;
+
+    // Hidden windows of released contexts, glfwDestroyWindow may only be called on the main thread
+    static std::mutex retiredLock;
+    static std::vector<GLFWwindow*> retired;
+
+public:
+    explicit GLFWSharedContext(GLFWwindow* window) : window(window) {}
+
+    ~GLFWSharedContext() override;
+
+    void makeCurrent(bool active) override;
+
+    // Destroys the hidden windows of the contexts released since the last call, on the main thread
+    static void destroyRetired();
+};
 
 class GLFWGameWindow : public GameWindow {
 private:
@@ -23,9 +46,8 @@ private:
     bool warnedButtons = false;
     bool requestFullscreen = false;
     bool pendingFullscreenModeSwitch = false;
-    std::vector<FullscreenMode> modes;
     FullscreenMode mode = {-1};
-    std::chrono::time_point<std::chrono::system_clock> lastFrame;
+    std::chrono::time_point<std::chrono::steady_clock> lastFrame;
     int swapInterval = 0;
     int checkBrokenVSync = 0;
     bool brokenVSync = false;
@@ -33,12 +55,25 @@ private:
     friend class GLFWJoystickManager;
 
 #ifdef GAMEWINDOW_X11_LOCK
-    std::recursive_mutex x11_sync;
+    // A vsync blocked present must not stall event pumping on another thread
+    X11Lock eventLock, presentLock;
 #endif
 
+    // Reads pastes without blocking the poll on X11, wakes up a waiting poll once done
+    X11ClipboardReader clipboardReader{[] { glfwPostEmptyEvent(); }};
+    bool asyncClipboard = false;
+
+    // Shared by all windows, invalidated by the monitor callback
+    static DisplayModeIndex<GLFWmonitor*, GLFWvidmode> modeIndex;
+
+    static std::vector<FullscreenMode> const& getMonitorModes(GLFWmonitor* monitor);
+
+    GLFWmonitor* getModeMonitor();
+
     static KeyCode getKeyMinecraft(int keyCode);
     static int translateMeta(unsigned int meta);
 
+    static void _glfwMonitorCallback(GLFWmonitor* monitor, int event);
     static void _glfwWindowSizeCallback(GLFWwindow* window, int w, int h);
     static void _glfwCursorPosCallback(GLFWwindow* window, double x, double y);
     static void _glfwMouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
@@ -49,6 +84,9 @@ private:
     static void _glfwWindowCloseCallback(GLFWwindow* window);
     static void _glfwWindowFocusCallback(GLFWwindow* window, int focused);
     static void _glfwWindowContentScaleCallback(GLFWwindow* window, float scalex, float scaley);
+    static void _glfwWindowIconifyCallback(GLFWwindow* window, int iconified);
+
+    void pumpEvents(double timeout);
 
 public:
     GLFWGameWindow(const std::string& title, int width, int height, GraphicsApi api);
@@ -63,12 +101,19 @@ public:
 
     void setRelativeScale();
 
+    // Reports the framebuffer size, window size and content scale after one of them changed
+    void updateSurface();
+
     void show() override;
 
     void close() override;
 
+    using GameWindow::pollEvents;
+
     void pollEvents() override;
 
+    void waitEvents(double timeout) override;
+
     bool getCursorDisabled() override;
 
     void setCursorDisabled(bool disabled) override;
@@ -85,9 +130,19 @@ public:
 
     void setSwapInterval(int interval) override;
 
+    int getSwapInterval() override;
+
+    double getDisplayRefreshRate() override;
+
+    std::shared_ptr<GameWindowSharedContext> createSharedContext() override;
+
+    LockWaitStats getEventLockWaitStats() override;
+
+    LockWaitStats getPresentLockWaitStats() override;
+
     void setFullscreenMode(const FullscreenMode& mode) override;
 
     FullscreenMode getFullscreenMode() override;
 
-    std::vector<FullscreenMode> getFullscreenModes() override;
+    std::vector<FullscreenMode> const& getFullscreenModes() override;
 };
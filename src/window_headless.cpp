@@ -0,0 +1,172 @@
+#include "window_headless.h"
+#include "game_window_metrics_collector.h"
+#include <EGL/eglext.h>
+#include <stdexcept>
+#include <thread>
+
+HeadlessGameWindow::HeadlessGameWindow(EGLDisplay display, const std::string& title, int width, int height, GraphicsApi api) : GameWindow(title, width, height, api), display(display), width(width), height(height), graphicsApi(api) {
+    EGLint renderableType = api == GraphicsApi::OPENGL ? EGL_OPENGL_BIT : EGL_OPENGL_ES2_BIT;
+    EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, renderableType,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_STENCIL_SIZE, 8,
+        EGL_NONE
+    };
+    EGLint numConfigs = 0;
+    if(!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs < 1)
+        throw std::runtime_error("EGL has no pbuffer config for the requested graphics api");
+    if(!eglBindAPI(api == GraphicsApi::OPENGL ? EGL_OPENGL_API : EGL_OPENGL_ES_API))
+        throw std::runtime_error("EGL doesn't support the requested graphics api");
+    context = createContext(api, EGL_NO_CONTEXT);
+    if(context == EGL_NO_CONTEXT)
+        throw std::runtime_error("Failed to create the EGL context");
+    EGLint surfaceAttribs[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+    surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+    if(surface == EGL_NO_SURFACE) {
+        eglDestroyContext(display, context);
+        throw std::runtime_error("Failed to create the EGL pbuffer");
+    }
+    eglMakeCurrent(display, surface, surface, context);
+    onContextCurrent();
+
+    // Reported by the first poll like the other implementations
+    setSurface(width, height, width, height, 1.0f, 1.0f);
+}
+
+EGLContext HeadlessGameWindow::createContext(GraphicsApi api, EGLContext share) {
+    if(api == GraphicsApi::OPENGL) {
+        EGLint attribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+            EGL_CONTEXT_MINOR_VERSION_KHR, 2,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+            EGL_NONE
+        };
+        return eglCreateContext(display, config, share, attribs);
+    }
+    // Failed to get es3 request es2
+    EGLint attribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+    EGLContext ctx = eglCreateContext(display, config, share, attribs);
+    if(ctx == EGL_NO_CONTEXT) {
+        attribs[1] = 2;
+        ctx = eglCreateContext(display, config, share, attribs);
+    }
+    return ctx;
+}
+
+HeadlessGameWindow::~HeadlessGameWindow() {
+    if(eglGetCurrentContext() == context)
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroySurface(display, surface);
+    eglDestroyContext(display, context);
+}
+
+void HeadlessGameWindow::setIcon(std::string const& iconPath) {
+}
+
+void HeadlessGameWindow::makeCurrent(bool active) {
+    if(active) {
+        eglMakeCurrent(display, surface, surface, context);
+        onContextCurrent();
+    } else {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    }
+}
+
+void HeadlessGameWindow::show() {
+}
+
+void HeadlessGameWindow::close() {
+    onClose();
+}
+
+void HeadlessGameWindow::pollEvents() {
+    beginPollEvents();
+    endPollEvents();
+}
+
+void HeadlessGameWindow::waitEvents(double timeout) {
+    // Only injected events can arrive, poll for them until the timeout passed
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeout));
+    while(!hasPendingInjectedEvents()) {
+        auto now = std::chrono::steady_clock::now();
+        if(now >= deadline)
+            break;
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(deadline - now, std::chrono::milliseconds(1)));
+    }
+    pollEvents();
+}
+
+bool HeadlessGameWindow::getCursorDisabled() {
+    return cursorDisabled;
+}
+
+void HeadlessGameWindow::setCursorDisabled(bool disabled) {
+    cursorDisabled = disabled;
+}
+
+bool HeadlessGameWindow::getFullscreen() {
+    return fullscreen;
+}
+
+void HeadlessGameWindow::setFullscreen(bool fullscreen) {
+    this->fullscreen = fullscreen;
+}
+
+void HeadlessGameWindow::getWindowSize(int& width, int& height) const {
+    width = this->width;
+    height = this->height;
+}
+
+void HeadlessGameWindow::setClipboardText(std::string const& text) {
+    clipboardText = text;
+}
+
+void HeadlessGameWindow::swapBuffers() {
+    // Doesn't present anything, only marks the end of the frame for the driver
+    beginSwapBuffers();
+    {
+        GameWindowMetricsCollector::Timer timer(GameWindowMetricsCollector::HistogramId::SWAP_DURATION);
+        eglSwapBuffers(display, surface);
+    }
+    endSwapBuffers();
+}
+
+void HeadlessGameWindow::setSwapInterval(int interval) {
+    swapInterval = interval;
+    // Pbuffers never wait for a vblank, pace to a virtual 60 Hz display instead so benchmarks see the same frame rate as on screen
+    setSwapIntervalEmulation(interval < 0 ? 1 : interval);
+}
+
+int HeadlessGameWindow::getSwapInterval() {
+    return swapInterval;
+}
+
+std::shared_ptr<GameWindowSharedContext> HeadlessGameWindow::createSharedContext() {
+    EGLContext shared = createContext(graphicsApi, context);
+    if(shared == EGL_NO_CONTEXT)
+        return nullptr;
+    EGLint surfaceAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+    EGLSurface sharedSurface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+    if(sharedSurface == EGL_NO_SURFACE) {
+        eglDestroyContext(display, shared);
+        return nullptr;
+    }
+    return std::make_shared<HeadlessSharedContext>(display, sharedSurface, shared);
+}
+
+HeadlessSharedContext::~HeadlessSharedContext() {
+    eglDestroySurface(display, surface);
+    eglDestroyContext(display, context);
+}
+
+void HeadlessSharedContext::makeCurrent(bool active) {
+    if(active)
+        eglMakeCurrent(display, surface, surface, context);
+    else
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
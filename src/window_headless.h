@@ -0,0 +1,74 @@
+#pragma once
+
+#include <game_window.h>
+#include <EGL/egl.h>
+
+class HeadlessSharedContext : public GameWindowSharedContext {
+private:
+    EGLDisplay display;
+    EGLSurface surface;
+    EGLContext context;
+
+public:
+    HeadlessSharedContext(EGLDisplay display, EGLSurface surface, EGLContext context) : display(display), surface(surface), context(context) {}
+
+    ~HeadlessSharedContext() override;
+
+    void makeCurrent(bool active) override;
+};
+
+// Renders into a pbuffer, events only come from injectEvent
+class HeadlessGameWindow : public GameWindow {
+private:
+    EGLDisplay display;
+    EGLConfig config = nullptr;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;
+    int width, height;
+    GraphicsApi graphicsApi;
+    bool cursorDisabled = false;
+    bool fullscreen = false;
+    int swapInterval = 0;
+    std::string clipboardText;
+
+    EGLContext createContext(GraphicsApi api, EGLContext share);
+
+public:
+    HeadlessGameWindow(EGLDisplay display, const std::string& title, int width, int height, GraphicsApi api);
+
+    ~HeadlessGameWindow() override;
+
+    void setIcon(std::string const& iconPath) override;
+
+    void makeCurrent(bool active) override;
+
+    void show() override;
+
+    void close() override;
+
+    using GameWindow::pollEvents;
+
+    void pollEvents() override;
+
+    void waitEvents(double timeout) override;
+
+    bool getCursorDisabled() override;
+
+    void setCursorDisabled(bool disabled) override;
+
+    bool getFullscreen() override;
+
+    void setFullscreen(bool fullscreen) override;
+
+    void getWindowSize(int& width, int& height) const override;
+
+    void setClipboardText(std::string const& text) override;
+
+    void swapBuffers() override;
+
+    void setSwapInterval(int interval) override;
+
+    int getSwapInterval() override;
+
+    std::shared_ptr<GameWindowSharedContext> createSharedContext() override;
+};
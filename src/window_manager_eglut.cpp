@@ -2,6 +2,7 @@
 #include "window_manager_eglut.h"
 #include "window_eglut.h"
 #include "joystick_manager_linux_gamepad.h"
+#include "startup_timings.h"
 #include <eglut.h>
 #include <eglut_x11.h>
 #include <unistd.h>
@@ -12,13 +13,18 @@
 #include <cstring>
 
 extern "C" void eglGetProcAddress();
+extern "C" int XInitThreads();
 
 EGLUTWindowManager::EGLUTWindowManager() {
+    // Has to happen before eglut opens the display, presenting and event pumping may run on different threads
+    XInitThreads();
     char buf[PATH_MAX];
     memset(buf, 0, sizeof(buf));
     readlink("/proc/self/exe", buf, sizeof(buf) - 1);
     eglutInitX11ClassInstanceName(basename(buf));
     eglutInit(0, nullptr); // the args aren't really required and are troublesome to pass with this system
+    // Read while the first window is created, its show waits for it
+    LinuxGamepadJoystickManager::instance.prefetchDefaultMappings();
 }
 
 GameWindowManager::ProcAddrFunc EGLUTWindowManager::getProcAddrFunc() {
@@ -27,7 +33,10 @@ GameWindowManager::ProcAddrFunc EGLUTWindowManager::getProcAddrFunc() {
 
 std::shared_ptr<GameWindow> EGLUTWindowManager::createWindow(const std::string& title, int width, int height,
                                                              GraphicsApi api) {
-    return std::shared_ptr<GameWindow>(new EGLUTWindow(title, width, height, api));
+    uint64_t start = GameWindow::getTimestamp();
+    auto window = std::shared_ptr<GameWindow>(new EGLUTWindow(title, width, height, api));
+    recordWindowCreated(start);
+    return window;
 }
 
 void EGLUTWindowManager::addGamepadMappingFile(const std::string &path) {
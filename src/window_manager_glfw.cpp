@@ -1,6 +1,7 @@
 #include "window_manager_glfw.h"
 #include "window_glfw.h"
 #include "joystick_manager_glfw.h"
+#include "startup_timings.h"
 #include <stdexcept>
 
 GLFWWindowManager::GLFWWindowManager() {
@@ -18,7 +19,10 @@ GameWindowManager::ProcAddrFunc GLFWWindowManager::getProcAddrFunc() {
 
 std::shared_ptr<GameWindow> GLFWWindowManager::createWindow(const std::string& title, int width, int height,
                                                              GraphicsApi api) {
-    return std::shared_ptr<GameWindow>(new GLFWGameWindow(title, width, height, api));
+    uint64_t start = GameWindow::getTimestamp();
+    auto window = std::shared_ptr<GameWindow>(new GLFWGameWindow(title, width, height, api));
+    recordWindowCreated(start);
+    return window;
 }
 
 void GLFWWindowManager::addGamepadMappingFile(const std::string &path) {
@@ -1,5 +1,8 @@
+#include "window_manager_glfw_fallback_eglut.h"
 #include "window_manager_glfw.h"
 #include "window_manager_eglut.h"
+#include "startup_timings.h"
+#include <game_window.h>
 #include <stdexcept>
 
 static bool ReadEnvFlag(const char* name, bool def = false) {
@@ -12,32 +15,47 @@ static bool ReadEnvFlag(const char* name, bool def = false) {
 }
 
 GLFWFallbackEGLUTWindowManager::GLFWFallbackEGLUTWindowManager() {
-    if(ReadEnvFlag("GAMEWINDOW_SYSTEM_EGLUT")) {
-        manager = new EGLUTWindowManager();
-    } else {
+    // Only built on linux, where neither backend is bound to the thread it was initialized on
+    // Both connect to the display server, which is most of the startup time spent before the first window
+    manager = std::async(std::launch::async, []() -> std::shared_ptr<GameWindowManager> {
+        recordStartupPhase(StartupPhase::BACKEND_PROBE_START, GameWindow::getTimestamp());
+        auto probe = []() -> std::shared_ptr<GameWindowManager> {
+            if(ReadEnvFlag("GAMEWINDOW_SYSTEM_EGLUT"))
+                return std::make_shared<EGLUTWindowManager>();
+            try {
+                return std::make_shared<GLFWWindowManager>();
+            } catch(...) {
+                return std::make_shared<EGLUTWindowManager>();
+            }
+        };
+        std::shared_ptr<GameWindowManager> backend;
         try {
-            manager = new GLFWWindowManager();
+            backend = probe();
         } catch(...) {
-            manager = new EGLUTWindowManager();
+            // Neither backend could be initialized, the exception reaches the first caller
+            recordStartupPhase(StartupPhase::BACKEND_PROBED, GameWindow::getTimestamp());
+            throw;
         }
-    }
+        recordStartupPhase(StartupPhase::BACKEND_PROBED, GameWindow::getTimestamp());
+        return backend;
+    }).share();
 }
 
 GameWindowManager::ProcAddrFunc GLFWFallbackEGLUTWindowManager::getProcAddrFunc() {
-    return manager->getProcAddrFunc();
+    return getBackend().getProcAddrFunc();
 }
 
 std::shared_ptr<GameWindow> GLFWFallbackEGLUTWindowManager::createWindow(const std::string& title, int width, int height,
                                                              GraphicsApi api) {
-    return manager->createWindow(title, width, height, api);
+    return getBackend().createWindow(title, width, height, api);
 }
 
 void GLFWFallbackEGLUTWindowManager::addGamepadMappingFile(const std::string &path) {
-    manager->addGamepadMappingFile(path);
+    getBackend().addGamepadMappingFile(path);
 }
 
 void GLFWFallbackEGLUTWindowManager::addGamePadMapping(const std::string &content) {
-    manager->addGamePadMapping(content);
+    getBackend().addGamePadMapping(content);
 }
 
 // Define this window manager as the used one
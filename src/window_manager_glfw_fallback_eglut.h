@@ -1,9 +1,16 @@
 #pragma once
 
 #include "game_window_manager.h"
+#include <future>
 
+// Uses GLFW, or EGLUT if GLFW can't be initialized or GAMEWINDOW_SYSTEM_EGLUT is set
+// The backends are probed on a worker thread, so the caller can continue its startup until the first call needs the manager
 class GLFWFallbackEGLUTWindowManager : public GameWindowManager {
-    std::shared_ptr<GameWindowManager> manager;
+    std::shared_future<std::shared_ptr<GameWindowManager>> manager;
+
+    // Waits for the probe, rethrows if neither backend could be initialized
+    GameWindowManager& getBackend() const { return *manager.get(); }
+
 public:
     GLFWFallbackEGLUTWindowManager();
 
@@ -14,4 +21,4 @@ public:
     void addGamepadMappingFile(const std::string& path) override;
 
     void addGamePadMapping(const std::string &content) override;
-};
\ No newline at end of file
+};
@@ -0,0 +1,45 @@
+#include "window_manager_headless.h"
+#include "window_headless.h"
+#include "startup_timings.h"
+#include <EGL/eglext.h>
+#include <cstring>
+#include <stdexcept>
+
+HeadlessWindowManager::HeadlessWindowManager() {
+    // Prefer the surfaceless platform, the default display may try to connect to X11 or Wayland
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (extensions != nullptr && strstr(extensions, "EGL_MESA_platform_surfaceless") != nullptr && getPlatformDisplay != nullptr)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+        throw std::runtime_error("Failed to initialize EGL for the headless window manager");
+}
+
+HeadlessWindowManager::~HeadlessWindowManager() {
+    eglTerminate(display);
+}
+
+GameWindowManager::ProcAddrFunc HeadlessWindowManager::getProcAddrFunc() {
+    return (GameWindowManager::ProcAddrFunc) eglGetProcAddress;
+}
+
+std::shared_ptr<GameWindow> HeadlessWindowManager::createWindow(const std::string& title, int width, int height,
+                                                                GraphicsApi api) {
+    uint64_t start = GameWindow::getTimestamp();
+    auto window = std::shared_ptr<GameWindow>(new HeadlessGameWindow(display, title, width, height, api));
+    recordWindowCreated(start);
+    return window;
+}
+
+void HeadlessWindowManager::addGamepadMappingFile(const std::string &path) {
+}
+
+void HeadlessWindowManager::addGamePadMapping(const std::string &content) {
+}
+
+// Define this window manager as the used one
+std::shared_ptr<GameWindowManager> GameWindowManager::createManager() {
+    return std::shared_ptr<GameWindowManager>(new HeadlessWindowManager());
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "game_window_manager.h"
+#include <EGL/egl.h>
+
+// No window system at all, windows render into pbuffers of a surfaceless or default EGL display
+class HeadlessWindowManager : public GameWindowManager {
+private:
+    EGLDisplay display = EGL_NO_DISPLAY;
+
+public:
+    HeadlessWindowManager();
+
+    ~HeadlessWindowManager();
+
+    ProcAddrFunc getProcAddrFunc() override;
+
+    std::shared_ptr<GameWindow> createWindow(const std::string& title, int width, int height, GraphicsApi api) override;
+
+    // There are no gamepads, gamepad events can only be injected
+    void addGamepadMappingFile(const std::string& path) override;
+
+    void addGamePadMapping(const std::string &content) override;
+};
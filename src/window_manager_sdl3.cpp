@@ -1,12 +1,14 @@
 #include "window_manager_sdl3.h"
 #include "window_sdl3.h"
+#include "gamepad_mapping_parser.h"
+#include "startup_timings.h"
 #include <stdexcept>
-#include <fstream>
 
 #include <SDL3/SDL.h>
 
-SDL3WindowManager::SDL3WindowManager() {
-    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_GAMEPAD);
+SDL3WindowManager::SDL3WindowManager() : mappingDatabase(SDL_GetPlatform()) {
+    // SDL_INIT_GAMEPAD is deferred to the first poll after a frame was presented
+    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS);
 }
 
 GameWindowManager::ProcAddrFunc SDL3WindowManager::getProcAddrFunc() {
@@ -15,31 +17,146 @@ GameWindowManager::ProcAddrFunc SDL3WindowManager::getProcAddrFunc() {
 
 std::shared_ptr<GameWindow> SDL3WindowManager::createWindow(const std::string& title, int width, int height,
                                                              GraphicsApi api) {
-    return std::shared_ptr<GameWindow>(new SDL3GameWindow(title, width, height, api));
+    uint64_t start = GameWindow::getTimestamp();
+    auto window = std::shared_ptr<GameWindow>(new SDL3GameWindow(title, width, height, api));
+    recordWindowCreated(start);
+    return window;
 }
 
 void SDL3WindowManager::addGamepadMappingFile(const std::string &path) {
-    // Not using this due to regression with the Gamepad Tool and ignoring all mappings without platform tag followed by comma
-    // SDL_AddGamepadMappingsFromFile(path.data());
-    std::string plat = SDL_GetPlatform();
-    std::string platsearchpattern1 = ",platform:" + plat;
-    std::string platsearchpattern2 = platsearchpattern1 + ",";
-    std::ifstream fs(path);
-    if (!fs)
+    // Not using SDL_AddGamepadMappingsFromFile due to regression with the Gamepad Tool and ignoring all mappings without platform tag followed by comma
+    if (!mappingDatabase.addFile(path))
         return;
+    int count = 0;
+    SDL_JoystickID* joysticks = SDL_GetJoysticks(&count);
+    if (joysticks == nullptr)
+        return;
+    for (int i = 0; i < count; i++)
+        applyGamepadMapping(joysticks[i]);
+    SDL_free(joysticks);
+}
+
+void SDL3WindowManager::addGamePadMapping(const std::string &content) {
+    // SDL only parses the first line
     std::string line;
-    int gamepads = 0;
-    while (std::getline(fs, line)) {
-        if (!line.empty() && (line.find(",platform:") == std::string::npos || line.find(platsearchpattern2) != std::string::npos || line.find(platsearchpattern1, line.size() - platsearchpattern1.size()) != std::string::npos)) {
-            if(SDL_AddGamepadMapping(line.data()) >= 0) {
-                gamepads++;
-            }
-        }
+    forEachGamepadMapping(content, [&](std::string_view mapping) {
+        line.assign(mapping);
+        SDL_AddGamepadMapping(line.c_str());
+    });
+    mappingDatabase.addOverride(content);
+}
+
+void SDL3WindowManager::applyGamepadMapping(SDL_JoystickID id) {
+    char guid[33];
+    SDL_GUIDToString(SDL_GetJoystickGUIDForID(id), guid, sizeof(guid));
+    auto mapping = mappingDatabase.find(guid);
+    if (!mapping.empty())
+        SDL_AddGamepadMapping(mapping.data());
+}
+
+std::vector<FullscreenMode> const& SDL3WindowManager::getDisplayModes(SDL_DisplayID display) {
+    return modeIndex.getModes(display, [display](std::vector<SDL_DisplayMode>& nativeModes) {
+        int nModes = 0;
+        SDL_DisplayMode** modes = SDL_GetFullscreenDisplayModes(display, &nModes);
+        if (modes == nullptr)
+            return;
+        for (int i = 0; i < nModes; i++)
+            nativeModes.push_back(*modes[i]);
+        SDL_free(modes);
+    }, [](SDL_DisplayMode const& mode) {
+        return FullscreenMode{.width = mode.w, .height = mode.h, .refreshRate = mode.refresh_rate, .pixelDensity = mode.pixel_density};
+    });
+}
+
+void SDL3WindowManager::addWindow(SDL_WindowID id, SDL3GameWindow* window) {
+    if (id >= windows.size())
+        windows.resize(id + 1);
+    windows[id] = window;
+    if (!gamepadsInitialized)
+        return;
+    // The window missed SDL_EVENT_GAMEPAD_ADDED of the gamepads connected before it, its poll assigns their slots
+    int count = 0;
+    SDL_JoystickID* gamepads = SDL_GetGamepads(&count);
+    if (gamepads == nullptr)
+        return;
+    for (int i = 0; i < count; i++) {
+        SDL_Event ev = {};
+        ev.type = SDL_EVENT_GAMEPAD_ADDED;
+        ev.gdevice.timestamp = SDL_GetTicksNS();
+        ev.gdevice.which = gamepads[i];
+        window->queueNativeEvent(ev);
     }
+    SDL_free(gamepads);
 }
 
-void SDL3WindowManager::addGamePadMapping(const std::string &content) {
-    SDL_AddGamepadMapping(content.data());
+void SDL3WindowManager::removeWindow(SDL_WindowID id) {
+    if (id < windows.size())
+        windows[id] = nullptr;
+}
+
+SDL_WindowID SDL3WindowManager::getEventWindowId(SDL_Event const& ev) {
+    switch (ev.type) {
+    case SDL_EVENT_MOUSE_MOTION:
+        return ev.motion.windowID;
+    case SDL_EVENT_MOUSE_WHEEL:
+        return ev.wheel.windowID;
+    case SDL_EVENT_MOUSE_BUTTON_DOWN:
+    case SDL_EVENT_MOUSE_BUTTON_UP:
+        return ev.button.windowID;
+    case SDL_EVENT_FINGER_DOWN:
+    case SDL_EVENT_FINGER_UP:
+    case SDL_EVENT_FINGER_MOTION:
+        return ev.tfinger.windowID;
+    case SDL_EVENT_KEY_DOWN:
+    case SDL_EVENT_KEY_UP:
+        return ev.key.windowID;
+    case SDL_EVENT_TEXT_INPUT:
+        return ev.text.windowID;
+    case SDL_EVENT_DROP_FILE:
+    case SDL_EVENT_DROP_TEXT:
+        return ev.drop.windowID;
+    default:
+        if (ev.type >= SDL_EVENT_WINDOW_FIRST && ev.type <= SDL_EVENT_WINDOW_LAST)
+            return ev.window.windowID;
+        return 0;
+    }
+}
+
+void SDL3WindowManager::pumpEvents(SDL3GameWindow* window, double timeout) {
+    // Only waits, the event stays queued for the loop below
+    if (timeout >= 0.0 && window->pendingEvents.empty())
+        SDL_WaitEventTimeout(nullptr, (Sint32)(timeout * 1000.0));
+    if (framePresented && !gamepadsInitialized) {
+        // Reports the connected joysticks and gamepads as added, the loop below applies the mappings and opens them
+        gamepadsInitialized = true;
+        SDL_InitSubSystem(SDL_INIT_GAMEPAD);
+    }
+    SDL_Event ev;
+    while (SDL_PollEvent(&ev)) {
+        // Handled once instead of per window
+        if (ev.type == SDL_EVENT_JOYSTICK_ADDED) {
+            applyGamepadMapping(ev.jdevice.which);
+            continue;
+        }
+        if (ev.type == SDL_EVENT_DISPLAY_ADDED || ev.type == SDL_EVENT_DISPLAY_REMOVED)
+            modeIndex.invalidate();
+        else if (ev.type == SDL_EVENT_GAMEPAD_ADDED)
+            SDL_OpenGamepad(ev.gdevice.which);
+        else if (ev.type == SDL_EVENT_GAMEPAD_REMOVED)
+            SDL_CloseGamepad(SDL_GetGamepadFromID(ev.gdevice.which));
+
+        SDL_WindowID id = getEventWindowId(ev);
+        if (id != 0) {
+            // Events of windows not created by us, e.g. the hidden windows of shared contexts, are dropped
+            if (id < windows.size() && windows[id] != nullptr)
+                windows[id]->queueNativeEvent(ev);
+            continue;
+        }
+        for (auto w : windows) {
+            if (w != nullptr)
+                w->queueNativeEvent(ev);
+        }
+    }
 }
 
 // Define this window manager as the used one
@@ -1,8 +1,27 @@
 #pragma once
 
 #include "game_window_manager.h"
+#include "gamepad_mapping_database.h"
+#include "display_mode_index.h"
+#include <SDL3/SDL.h>
+#include <vector>
+
+class SDL3GameWindow;
 
 class SDL3WindowManager : public GameWindowManager {
+private:
+    // Files are only indexed, the mapping of a joystick is handed to SDL when it connects
+    GamepadMappingDatabase mappingDatabase;
+    // Indexed by SDL_WindowID
+    std::vector<SDL3GameWindow*> windows;
+    // Shared by all windows, invalidated when a display is added or removed
+    DisplayModeIndex<SDL_DisplayID, SDL_DisplayMode> modeIndex;
+
+    // The gamepad subsystem enumerates the HID devices, which can take longer than showing the first frame
+    bool framePresented = false;
+    bool gamepadsInitialized = false;
+
+    static SDL_WindowID getEventWindowId(SDL_Event const& ev);
 
 public:
     SDL3WindowManager();
@@ -14,4 +33,28 @@ public:
     void addGamepadMappingFile(const std::string& path) override;
 
     void addGamePadMapping(const std::string &content) override;
+
+    // Called for SDL_EVENT_JOYSTICK_ADDED, SDL reports the joystick as gamepad once it has a mapping
+    void applyGamepadMapping(SDL_JoystickID id);
+
+    std::vector<FullscreenMode> const& getDisplayModes(SDL_DisplayID display);
+
+    // nullptr if the display has no such mode, see DisplayModeIndex::findNativeMode
+    const SDL_DisplayMode* findDisplayMode(SDL_DisplayID display, FullscreenMode const& mode) {
+        getDisplayModes(display);
+        return modeIndex.findNativeMode(display, mode);
+    }
+
+    void addWindow(SDL_WindowID id, SDL3GameWindow* window);
+
+    void removeWindow(SDL_WindowID id);
+
+    // Called by the windows after presenting, the gamepad subsystem is started by the next pumpEvents
+    void onFramePresented() { framePresented = true; }
+
+    // Drains the SDL event queue shared by all windows into the queue of the window owning each event, other events go to all windows
+    // Waits up to timeout seconds if nothing is queued for the given window yet, a negative timeout doesn't wait
+    // Called by the poll of any window, so every window has to poll to get its events. A window which doesn't poll
+    // while SDL3GameWindow::MAX_PENDING_EVENTS events are queued for it loses them.
+    void pumpEvents(SDL3GameWindow* window, double timeout);
 };
\ No newline at end of file
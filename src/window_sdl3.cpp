@@ -1,12 +1,13 @@
 #include "window_sdl3.h"
 #include "game_window_manager.h"
+#include "window_manager_sdl3.h"
+#include "game_window_metrics_collector.h"
 
-#include <codecvt>
 #include <iomanip>
 #include <thread>
-#include <sstream>
 
 #include <math.h>
+#include <cstring>
 #include <SDL3/SDL.h>
 
 struct SDL_X11CursorData {
@@ -47,6 +48,10 @@ SDL3GameWindow::SDL3GameWindow(const std::string& title, int width, int height,
         throw std::runtime_error(error == nullptr ? "SDL3 failed to create a window context without any error message" : error);
     }
     SDL_GL_MakeCurrent(window, context);
+    onContextCurrent();
+
+    manager = std::static_pointer_cast<SDL3WindowManager>(GameWindowManager::getManager()).get();
+    manager->addWindow(SDL_GetWindowID(window), this);
 
     // SDL_SetHint(SDL_HINT_ENABLE_SCREEN_KEYBOARD, "0");
     SDL_StopTextInput(window);
@@ -54,6 +59,7 @@ SDL3GameWindow::SDL3GameWindow(const std::string& title, int width, int height,
 
     // HACK: Force SDL to not alter the cursor on x11, fixing cursor scaling issues
     if(strcmp(SDL_GetCurrentVideoDriver(), "x11") == 0) {
+        asyncClipboard = true;
         SDL_X11Cursor* def = (SDL_X11Cursor*)SDL_GetDefaultCursor();
         def->internal->cursor = NULL;
     }
@@ -61,13 +67,17 @@ SDL3GameWindow::SDL3GameWindow(const std::string& title, int width, int height,
 
 void SDL3GameWindow::makeCurrent(bool c) {
     SDL_GL_MakeCurrent(window, c ? context : nullptr);
+    if(c)
+        onContextCurrent();
 }
 
 SDL3GameWindow::~SDL3GameWindow() {
     if(window) {
+        manager->removeWindow(SDL_GetWindowID(window));
         SDL_DestroyWindow(window);
         window = nullptr;
     }
+    SDL3SharedContext::destroyRetired();
 }
 
 void SDL3GameWindow::setIcon(std::string const& iconPath) {
@@ -86,6 +96,7 @@ void SDL3GameWindow::setRelativeScale() {
     // Update window size to match content size mismatch
     width = fx;
     height = fy;
+    setDrawableSize(width, height);
     resized = true;
 }
 
@@ -105,6 +116,8 @@ void SDL3GameWindow::show() {
 void SDL3GameWindow::close() {
     if(window) {
         onClose();
+        // The manager must not queue events for the window anymore, the destructor skips this once window is reset
+        manager->removeWindow(SDL_GetWindowID(window));
         SDL_DestroyWindow(window);
         window = nullptr;
     }
@@ -183,13 +196,53 @@ static int getMouseButton(int btn) {
     }
 }
 
-static std::string getModeDescription(const SDL_DisplayMode* mode) {
-    std::stringstream desc;
-    desc << mode->w << "x" << mode->h << " @ " << mode->refresh_rate << " * " << mode->pixel_density;
-    return desc.str();
+int SDL3GameWindow::getGamepadSlot(SDL_JoystickID instanceId, bool assign) {
+    // Instance ids grow with every reconnect, report small reusable ids like the other implementations
+    for(int i = 0; i < MAX_GAMEPADS; i++) {
+        if(gamepadSlots[i] == instanceId)
+            return i;
+    }
+    if(assign) {
+        for(int i = 0; i < MAX_GAMEPADS; i++) {
+            if(gamepadSlots[i] == 0) {
+                gamepadSlots[i] = instanceId;
+                return i;
+            }
+        }
+    }
+    return -1;
 }
 
 void SDL3GameWindow::pollEvents() {
+    pumpEvents(-1.0);
+}
+
+void SDL3GameWindow::waitEvents(double timeout) {
+    pumpEvents(timeout);
+}
+
+void SDL3GameWindow::queueNativeEvent(SDL_Event const& ev) {
+    if(pendingEvents.size() >= MAX_PENDING_EVENTS) {
+        // The window didn't poll for long, e.g. one which is only rendered, its stale events are discarded
+        GameWindowMetricsCollector::add(GameWindowMetricsCollector::CounterId::DROPPED_EVENTS, pendingEvents.size());
+        pendingEvents.clear();
+        pendingText.clear();
+    }
+    const char* text = nullptr;
+    if(ev.type == SDL_EVENT_TEXT_INPUT)
+        text = ev.text.text;
+    else if(ev.type == SDL_EVENT_DROP_FILE || ev.type == SDL_EVENT_DROP_TEXT)
+        text = ev.drop.data;
+    uint32_t textOffset = UINT32_MAX;
+    if(text != nullptr) {
+        textOffset = (uint32_t)pendingText.size();
+        // Keeps the terminator
+        pendingText.append(text, strlen(text) + 1);
+    }
+    pendingEvents.push_back({ev, textOffset});
+}
+
+void SDL3GameWindow::pumpEvents(double timeout) {
     if(requestedWindowMode != None) {
         SDL_SetWindowFullscreen(window, requestedWindowMode == RequestWindowMode::Fullscreen);
         requestedWindowMode = RequestWindowMode::None;
@@ -198,23 +251,34 @@ void SDL3GameWindow::pollEvents() {
         pendingFullscreenModeSwitch = false;
         if(mode.id == -1) {
             SDL_SetWindowFullscreenMode(window, NULL);
-        } else {
-            int nModes = 0;
-            auto display = SDL_GetDisplayForWindow(window);
-            auto modes = SDL_GetFullscreenDisplayModes(display, &nModes);
-            if(nModes > mode.id && mode.description == getModeDescription(modes[mode.id])) {
-                SDL_SetWindowFullscreenMode(window, modes[mode.id]);
-            }
+        } else if(auto nativeMode = manager->findDisplayMode(SDL_GetDisplayForWindow(window), mode)) {
+            SDL_SetWindowFullscreenMode(window, nativeMode);
         }
     }
-    SDL_Event ev;
-    while(SDL_PollEvent(&ev)) {
+    beginPollEvents();
+    manager->pumpEvents(this, timeout);
+    SDL3SharedContext::destroyRetired();
+    // SDL timestamps are based on SDL_GetTicksNS, convert them to our clock
+    uint64_t timestampOffset = getTimestamp() - SDL_GetTicksNS();
+    // Events queued by the handlers below, e.g. by another window's poll, go to the next poll
+    std::swap(pendingEvents, dispatchedEvents);
+    std::swap(pendingText, dispatchedText);
+    for(auto& queued : dispatchedEvents) {
+        SDL_Event& ev = queued.event;
+        if(queued.textOffset != UINT32_MAX) {
+            const char* text = dispatchedText.c_str() + queued.textOffset;
+            if(ev.type == SDL_EVENT_TEXT_INPUT)
+                ev.text.text = text;
+            else
+                ev.drop.data = text;
+        }
+        setEventTimestamp(ev.common.timestamp + timestampOffset);
         switch(ev.type) {
         case SDL_EVENT_MOUSE_MOTION:
             if(!SDL_GetWindowRelativeMouseMode(window)) {
                 onMousePosition(ev.motion.x * relativeScaleX, ev.motion.y * relativeScaleY);
             } else {
-                onMouseRelativePosition(ev.motion.xrel, ev.motion.yrel);
+                onMouseRelativePosition(ev.motion.xrel * relativeScaleX, ev.motion.yrel * relativeScaleY);
             }
             break;
         case SDL_EVENT_MOUSE_WHEEL:
@@ -224,24 +288,15 @@ void SDL3GameWindow::pollEvents() {
         case SDL_EVENT_MOUSE_BUTTON_UP:
             onMouseButton(ev.button.x, ev.button.y, getMouseButton(ev.button.button), ev.type == SDL_EVENT_MOUSE_BUTTON_DOWN ? MouseButtonAction::PRESS : MouseButtonAction::RELEASE);
             break;
-        case SDL_EVENT_FINGER_DOWN: {
-            int w, h;
-            getWindowSize(w, h);
-            onTouchStart(ev.tfinger.fingerID, ev.tfinger.x * w, ev.tfinger.y * h);
+        case SDL_EVENT_FINGER_DOWN:
+            onNativeTouchStart((int64_t)ev.tfinger.fingerID, ev.tfinger.x * width, ev.tfinger.y * height, ev.tfinger.pressure);
             break;
-        }
-        case SDL_EVENT_FINGER_UP: {
-            int w, h;
-            getWindowSize(w, h);
-            onTouchEnd(ev.tfinger.fingerID, ev.tfinger.x * w, ev.tfinger.y * h);
+        case SDL_EVENT_FINGER_UP:
+            onNativeTouchEnd((int64_t)ev.tfinger.fingerID, ev.tfinger.x * width, ev.tfinger.y * height, ev.tfinger.pressure);
             break;
-        }
-        case SDL_EVENT_FINGER_MOTION: {
-            int w, h;
-            getWindowSize(w, h);
-            onTouchUpdate(ev.tfinger.fingerID, ev.tfinger.x * w, ev.tfinger.y * h);
+        case SDL_EVENT_FINGER_MOTION:
+            onNativeTouchUpdate((int64_t)ev.tfinger.fingerID, ev.tfinger.x * width, ev.tfinger.y * height, ev.tfinger.pressure);
             break;
-        }
         case SDL_EVENT_KEY_DOWN:
         case SDL_EVENT_KEY_UP:
             if(ev.type == SDL_EVENT_KEY_DOWN) {
@@ -254,34 +309,43 @@ void SDL3GameWindow::pollEvents() {
                         onKeyboardText("\n");
                     }
                 } else if(ev.key.key < 0x40000000) {
-                    onKeyboardText(std::string(1, (char)ev.key.key));
+                    // Printable keycodes are unicode codepoints
+                    onKeyboardText((char32_t)ev.key.key);
                 }
             }
 
             SDL_Keymod mods;
             mods = SDL_GetModState();
             if(mods & SDL_KMOD_CTRL && ev.key.key == SDLK_V && ev.type == SDL_EVENT_KEY_DOWN) {
-                auto str = SDL_GetClipboardText();
-                onPaste(str);
+                requestPaste();
             }
             onKeyboard(getKeyMinecraft(SDL_GetKeyFromScancode(ev.key.scancode, SDL_KMOD_NONE, false)), ev.type == SDL_EVENT_KEY_DOWN ? ev.key.repeat ? KeyAction::REPEAT : KeyAction::PRESS : KeyAction::RELEASE, translateMeta(mods));
             break;
         case SDL_EVENT_GAMEPAD_BUTTON_DOWN:
-        case SDL_EVENT_GAMEPAD_BUTTON_UP:
-            onGamepadButton(ev.gbutton.which, getKeyGamePad(ev.gbutton.button), ev.type == SDL_EVENT_GAMEPAD_BUTTON_DOWN);
+        case SDL_EVENT_GAMEPAD_BUTTON_UP: {
+            // Gamepads without a slot were never reported as connected, e.g. all slots were in use
+            int slot = getGamepadSlot(ev.gbutton.which, false);
+            if(slot != -1)
+                onGamepadButton(slot, getKeyGamePad(ev.gbutton.button), ev.type == SDL_EVENT_GAMEPAD_BUTTON_DOWN);
             break;
-        case SDL_EVENT_GAMEPAD_AXIS_MOTION:
-            onGamepadAxis(ev.gaxis.which, getAxisGamepad(ev.gaxis.axis), (float)ev.gaxis.value / 32767.0f);
+        }
+        case SDL_EVENT_GAMEPAD_AXIS_MOTION: {
+            int slot = getGamepadSlot(ev.gaxis.which, false);
+            if(slot != -1)
+                onGamepadAxis(slot, getAxisGamepad(ev.gaxis.axis), (float)ev.gaxis.value / 32767.0f);
             break;
+        }
         case SDL_EVENT_GAMEPAD_ADDED:
         case SDL_EVENT_GAMEPAD_REMOVED: {
-            if(ev.type == SDL_EVENT_GAMEPAD_ADDED) {
-                SDL_OpenGamepad(ev.gdevice.which);
-            }
-            onGamepadState(ev.gdevice.which, ev.type == SDL_EVENT_GAMEPAD_ADDED);
-            if(ev.type == SDL_EVENT_GAMEPAD_REMOVED) {
-                SDL_CloseGamepad(SDL_GetGamepadFromID(ev.gdevice.which));
-            }
+            // Already reported by the replay of SDL3WindowManager::addWindow if SDL's own event was still queued
+            if(ev.type == SDL_EVENT_GAMEPAD_ADDED && getGamepadSlot(ev.gdevice.which, false) != -1)
+                break;
+            // The manager opens and closes the gamepad
+            int slot = getGamepadSlot(ev.gdevice.which, ev.type == SDL_EVENT_GAMEPAD_ADDED);
+            if(slot != -1)
+                onGamepadState(slot, ev.type == SDL_EVENT_GAMEPAD_ADDED);
+            if(ev.type == SDL_EVENT_GAMEPAD_REMOVED && slot != -1)
+                gamepadSlots[slot] = 0;
             break;
         }
         case SDL_EVENT_WINDOW_RESIZED:
@@ -296,7 +360,7 @@ void SDL3GameWindow::pollEvents() {
             }
             break;
         case SDL_EVENT_TEXT_INPUT:
-            onKeyboardText(ev.text.text ? ev.text.text : "");
+            onKeyboardText(std::string_view(ev.text.text ? ev.text.text : ""));
             break;
         case SDL_EVENT_DROP_FILE:
             onDrop(ev.drop.data);
@@ -309,13 +373,24 @@ void SDL3GameWindow::pollEvents() {
             onClose();
             break;
         case SDL_EVENT_WINDOW_DISPLAY_CHANGED:
-            modes.clear();
             setRelativeScale();
             break;
         case SDL_EVENT_WINDOW_DISPLAY_SCALE_CHANGED:
             setRelativeScale();
             break;
+        case SDL_EVENT_WINDOW_MINIMIZED:
+        case SDL_EVENT_WINDOW_OCCLUDED:
+        case SDL_EVENT_WINDOW_HIDDEN:
+            onVisibility(false);
+            break;
+        case SDL_EVENT_WINDOW_RESTORED:
+        case SDL_EVENT_WINDOW_EXPOSED:
+        case SDL_EVENT_WINDOW_SHOWN:
+            onVisibility(true);
+            break;
         case SDL_EVENT_WINDOW_FOCUS_GAINED:
+            focused = true;
+            onFocus(true);
             if(cursorDisabled) {
                 float x, y;
                 SDL_GetGlobalMouseState(&x, &y);
@@ -327,6 +402,8 @@ void SDL3GameWindow::pollEvents() {
             }
             break;
         case SDL_EVENT_WINDOW_FOCUS_LOST:
+            focused = false;
+            onFocus(false);
             if(cursorDisabled) {
                 SDL_SetWindowRelativeMouseMode(window, false);
                 SDL_SetWindowMouseRect(window, NULL);
@@ -339,9 +416,27 @@ void SDL3GameWindow::pollEvents() {
             break;
         }
     }
+    dispatchedEvents.clear();
+    dispatchedText.clear();
+    setEventTimestamp(0);
     if(resized) {
-        onWindowSizeChanged(width, height);
+        resized = false;
+        int wx, wy;
+        SDL_GetWindowSize(window, &wx, &wy);
+        float scale = SDL_GetWindowDisplayScale(window);
+        setSurface(width, height, wx, wy, scale, scale);
+    }
+    if(takePasteRequest() && !(asyncClipboard && clipboardReader.request())) {
+        char* str = SDL_GetClipboardText();
+        if(str != nullptr) {
+            onPaste(str);
+            SDL_free(str);
+        }
     }
+    std::string pasted;
+    if(clipboardReader.take(pasted))
+        onPaste(pasted);
+    endPollEvents();
 }
 
 bool SDL3GameWindow::getCursorDisabled() {
@@ -384,31 +479,19 @@ void SDL3GameWindow::setFullscreenMode(const FullscreenMode& mode) {
 }
 
 FullscreenMode SDL3GameWindow::getFullscreenMode() {
-    auto display = SDL_GetDisplayForWindow(window);
-    int nModes;
-    auto modes = SDL_GetFullscreenDisplayModes(display, &nModes);
+    auto& modes = getFullscreenModes();
     auto mode = SDL_GetWindowFullscreenMode(window);
-    if(mode && modes) {
-        auto desc = getModeDescription(mode);
-        for(int i = 0; i < nModes; i++) {
-            if(desc == getModeDescription(modes[i])) {
-                return FullscreenMode{.id = i, .description = desc};
-            }
+    if(mode) {
+        for(auto& m : modes) {
+            if(m.width == mode->w && m.height == mode->h && m.refreshRate == (double)mode->refresh_rate && m.pixelDensity == (double)mode->pixel_density)
+                return m;
         }
     }
     return FullscreenMode{-1};
 }
 
-std::vector<FullscreenMode> SDL3GameWindow::getFullscreenModes() {
-    if(modes.empty()) {
-        int nModes = 0;
-        auto display = SDL_GetDisplayForWindow(window);
-        auto modes = SDL_GetFullscreenDisplayModes(display, &nModes);
-        for(int j = 0; j < nModes; j++) {
-            this->modes.emplace_back(FullscreenMode{.id = j, .description = getModeDescription(modes[j])});
-        }
-    }
-    return modes;
+std::vector<FullscreenMode> const& SDL3GameWindow::getFullscreenModes() {
+    return manager->getDisplayModes(SDL_GetDisplayForWindow(window));
 }
 
 bool SDL3GameWindow::getFullscreen() {
@@ -427,11 +510,79 @@ void SDL3GameWindow::setClipboardText(std::string const& text) {
 }
 
 void SDL3GameWindow::swapBuffers() {
-    SDL_GL_SwapWindow(window);
+    beginSwapBuffers();
+    {
+        GameWindowMetricsCollector::Timer timer(GameWindowMetricsCollector::HistogramId::SWAP_DURATION);
+        SDL_GL_SwapWindow(window);
+    }
+    endSwapBuffers();
+    manager->onFramePresented();
 }
 
 void SDL3GameWindow::setSwapInterval(int interval) {
-    SDL_GL_SetSwapInterval(interval);
+    // Fails if adaptive vsync isn't supported
+    if(!SDL_GL_SetSwapInterval(interval) && interval < 0)
+        SDL_GL_SetSwapInterval(1);
+}
+
+int SDL3GameWindow::getSwapInterval() {
+    int interval = 0;
+    SDL_GL_GetSwapInterval(&interval);
+    return interval;
+}
+
+double SDL3GameWindow::getDisplayRefreshRate() {
+    const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window));
+    return mode != nullptr ? mode->refresh_rate : 0.0;
+}
+
+std::shared_ptr<GameWindowSharedContext> SDL3GameWindow::createSharedContext() {
+    SDL_Window* shared = SDL_CreateWindow("", 1, 1, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    if(shared == nullptr) {
+        GameWindowManager::getManager()->getErrorHandler()->onError("SDL3 Shared Context", SDL_GetError());
+        return nullptr;
+    }
+    // The context attributes of the window are still set, sharing requires its context to be current
+    SDL_Window* prevWindow = SDL_GL_GetCurrentWindow();
+    SDL_GLContext prevContext = SDL_GL_GetCurrentContext();
+    SDL_GL_MakeCurrent(window, context);
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+    SDL_GLContext sharedContext = SDL_GL_CreateContext(shared);
+    SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+    SDL_GL_MakeCurrent(prevWindow, prevContext);
+    if(sharedContext == nullptr) {
+        GameWindowManager::getManager()->getErrorHandler()->onError("SDL3 Shared Context", SDL_GetError());
+        SDL_DestroyWindow(shared);
+        return nullptr;
+    }
+    return std::make_shared<SDL3SharedContext>(shared, sharedContext);
+}
+
+std::mutex SDL3SharedContext::retiredLock;
+std::vector<std::pair<SDL_Window*, SDL_GLContext>> SDL3SharedContext::retired;
+
+SDL3SharedContext::~SDL3SharedContext() {
+    // The last reference is usually dropped on the worker, which may still have the context current
+    if(SDL_GL_GetCurrentContext() == context)
+        SDL_GL_MakeCurrent(window, nullptr);
+    std::lock_guard<std::mutex> lock(retiredLock);
+    retired.emplace_back(window, context);
+}
+
+void SDL3SharedContext::destroyRetired() {
+    std::vector<std::pair<SDL_Window*, SDL_GLContext>> contexts;
+    {
+        std::lock_guard<std::mutex> lock(retiredLock);
+        contexts.swap(retired);
+    }
+    for(auto& shared : contexts) {
+        SDL_GL_DestroyContext(shared.second);
+        SDL_DestroyWindow(shared.first);
+    }
+}
+
+void SDL3SharedContext::makeCurrent(bool active) {
+    SDL_GL_MakeCurrent(window, active ? context : nullptr);
 }
 
 void SDL3GameWindow::startTextInput() {
@@ -455,265 +606,98 @@ bool SDL3GameWindow::isMouseInWindow() {
     return (mouseX >= windowX && mouseY >= windowY && mouseX <= windowX + width && mouseY <= windowY + height);
 }
 
+// Keys without a printable keycode are translated by scancode, so they are shared with getKeyFromKeyCode
+static constexpr NativeKeyMapping sdlScancodeMappings[] = {
+    mapKeys(SDL_SCANCODE_A, KeyCode::A, 26),
+    mapKeys(SDL_SCANCODE_1, KeyCode::NUM_1, 9),
+    mapKey(SDL_SCANCODE_0, KeyCode::NUM_0),
+    mapKeys(SDL_SCANCODE_F1, KeyCode::FN1, 12),
+    mapKeys(SDL_SCANCODE_KP_1, KeyCode::NUMPAD_1, 9),
+    mapKey(SDL_SCANCODE_KP_0, KeyCode::NUMPAD_0),
+    mapKey(SDL_SCANCODE_AC_BACK, KeyCode::BACK),
+    mapKey(SDL_SCANCODE_BACKSPACE, KeyCode::BACKSPACE),
+    mapKey(SDL_SCANCODE_TAB, KeyCode::TAB),
+    mapKey(SDL_SCANCODE_RETURN, KeyCode::ENTER),
+    mapKey(SDL_SCANCODE_LSHIFT, KeyCode::LEFT_SHIFT),
+    mapKey(SDL_SCANCODE_RSHIFT, KeyCode::RIGHT_SHIFT),
+    mapKey(SDL_SCANCODE_LCTRL, KeyCode::LEFT_CTRL),
+    mapKey(SDL_SCANCODE_RCTRL, KeyCode::RIGHT_CTRL),
+    mapKey(SDL_SCANCODE_PAUSE, KeyCode::PAUSE),
+    mapKey(SDL_SCANCODE_CAPSLOCK, KeyCode::CAPS_LOCK),
+    mapKey(SDL_SCANCODE_ESCAPE, KeyCode::ESCAPE),
+    mapKey(SDL_SCANCODE_SPACE, KeyCode::SPACE),
+    mapKey(SDL_SCANCODE_PAGEUP, KeyCode::PAGE_UP),
+    mapKey(SDL_SCANCODE_PAGEDOWN, KeyCode::PAGE_DOWN),
+    mapKey(SDL_SCANCODE_END, KeyCode::END),
+    mapKey(SDL_SCANCODE_HOME, KeyCode::HOME),
+    mapKey(SDL_SCANCODE_LEFT, KeyCode::LEFT),
+    mapKey(SDL_SCANCODE_UP, KeyCode::UP),
+    mapKey(SDL_SCANCODE_RIGHT, KeyCode::RIGHT),
+    mapKey(SDL_SCANCODE_DOWN, KeyCode::DOWN),
+    mapKey(SDL_SCANCODE_INSERT, KeyCode::INSERT),
+    mapKey(SDL_SCANCODE_DELETE, KeyCode::DELETE),
+    mapKey(SDL_SCANCODE_NUMLOCKCLEAR, KeyCode::NUM_LOCK),
+    mapKey(SDL_SCANCODE_SCROLLLOCK, KeyCode::SCROLL_LOCK),
+    mapKey(SDL_SCANCODE_SEMICOLON, KeyCode::SEMICOLON),
+    mapKey(SDL_SCANCODE_EQUALS, KeyCode::EQUAL),
+    mapKey(SDL_SCANCODE_COMMA, KeyCode::COMMA),
+    mapKey(SDL_SCANCODE_MINUS, KeyCode::MINUS),
+    mapKey(SDL_SCANCODE_PERIOD, KeyCode::PERIOD),
+    mapKey(SDL_SCANCODE_SLASH, KeyCode::SLASH),
+    mapKey(SDL_SCANCODE_GRAVE, KeyCode::GRAVE),
+    mapKey(SDL_SCANCODE_LEFTBRACKET, KeyCode::LEFT_BRACKET),
+    mapKey(SDL_SCANCODE_BACKSLASH, KeyCode::BACKSLASH),
+    mapKey(SDL_SCANCODE_RIGHTBRACKET, KeyCode::RIGHT_BRACKET),
+    mapKey(SDL_SCANCODE_APOSTROPHE, KeyCode::APOSTROPHE),
+    mapKey(SDL_SCANCODE_MENU, KeyCode::MENU),
+    mapKey(SDL_SCANCODE_LGUI, KeyCode::LEFT_SUPER),
+    mapKey(SDL_SCANCODE_RGUI, KeyCode::RIGHT_SUPER),
+    mapKey(SDL_SCANCODE_LALT, KeyCode::LEFT_ALT),
+    mapKey(SDL_SCANCODE_RALT, KeyCode::RIGHT_ALT),
+    mapKeyAlias(SDL_SCANCODE_KP_ENTER, KeyCode::ENTER),
+    mapKey(SDL_SCANCODE_KP_MINUS, KeyCode::NUMPAD_SUBTRACT),
+    mapKey(SDL_SCANCODE_KP_MULTIPLY, KeyCode::NUMPAD_MULTIPLY),
+    mapKey(SDL_SCANCODE_KP_PLUS, KeyCode::NUMPAD_ADD),
+    mapKey(SDL_SCANCODE_KP_DIVIDE, KeyCode::NUMPAD_DIVIDE),
+    mapKey(SDL_SCANCODE_KP_DECIMAL, KeyCode::NUMPAD_DECIMAL),
+};
+// Printable keycodes depend on the keyboard layout
+static constexpr NativeKeyMapping sdlKeycodeMappings[] = {
+    mapKeys(SDLK_A, KeyCode::A, 26),
+    mapKey(SDLK_BACKSPACE, KeyCode::BACKSPACE),
+    mapKey(SDLK_TAB, KeyCode::TAB),
+    mapKey(SDLK_RETURN, KeyCode::ENTER),
+    mapKey(SDLK_ESCAPE, KeyCode::ESCAPE),
+    mapKey(SDLK_DELETE, KeyCode::DELETE),
+    mapKey(SDLK_SEMICOLON, KeyCode::SEMICOLON),
+    mapKey(SDLK_EQUALS, KeyCode::EQUAL),
+    mapKey(SDLK_COMMA, KeyCode::COMMA),
+    mapKey(SDLK_MINUS, KeyCode::MINUS),
+    mapKey(SDLK_PERIOD, KeyCode::PERIOD),
+    mapKey(SDLK_SLASH, KeyCode::SLASH),
+    mapKey(SDLK_GRAVE, KeyCode::GRAVE),
+    mapKey(SDLK_LEFTBRACKET, KeyCode::LEFT_BRACKET),
+    mapKey(SDLK_BACKSLASH, KeyCode::BACKSLASH),
+    mapKey(SDLK_RIGHTBRACKET, KeyCode::RIGHT_BRACKET),
+    mapKey(SDLK_APOSTROPHE, KeyCode::APOSTROPHE),
+};
+static constexpr NativeKeyTable<0, SDL_SCANCODE_COUNT - 1> sdlScancodeKeys(sdlScancodeMappings);
+static constexpr KeyCodeTable<SDL_SCANCODE_UNKNOWN> sdlScancodes(sdlScancodeMappings);
+static_assert(sdlScancodes.isInverseOf(sdlScancodeKeys), "Key mapped twice in sdlScancodeMappings");
+// Keycodes below 256 without a mapping match the KeyCode values
+static constexpr NativeKeyTable<0, 0xff> sdlKeycodeKeys(sdlKeycodeMappings, true);
+static_assert(KeyCodeTable<0>(sdlKeycodeMappings).isInverseOf(sdlKeycodeKeys), "Key mapped twice in sdlKeycodeMappings");
+
 KeyCode SDL3GameWindow::getKeyMinecraft(int keyCode) {
-    if(keyCode >= SDLK_F1 && keyCode <= SDLK_F12)
-        return (KeyCode)(keyCode - SDLK_F1 + (int)KeyCode::FN1);
-    if(keyCode >= SDLK_KP_1 && keyCode <= SDLK_KP_9)
-        return (KeyCode)(keyCode - SDLK_KP_1 + (int)KeyCode::NUMPAD_1);
-    if(keyCode >= SDLK_A && keyCode <= SDLK_Z)
-        return (KeyCode)(keyCode - SDLK_A + (int)KeyCode::A);
-    switch(keyCode) {
-    case SDLK_BACKSPACE:
-        return KeyCode::BACKSPACE;
-    case SDLK_TAB:
-        return KeyCode::TAB;
-    case SDLK_RETURN:
-        return KeyCode::ENTER;
-    case SDLK_LSHIFT:
-        return KeyCode::LEFT_SHIFT;
-    case SDLK_RSHIFT:
-        return KeyCode::RIGHT_SHIFT;
-    case SDLK_LCTRL:
-        return KeyCode::LEFT_CTRL;
-    case SDLK_RCTRL:
-        return KeyCode::RIGHT_CTRL;
-    case SDLK_PAUSE:
-        return KeyCode::PAUSE;
-    case SDLK_CAPSLOCK:
-        return KeyCode::CAPS_LOCK;
-    case SDLK_ESCAPE:
-        return KeyCode::ESCAPE;
-    case SDLK_PAGEUP:
-        return KeyCode::PAGE_UP;
-    case SDLK_PAGEDOWN:
-        return KeyCode::PAGE_DOWN;
-    case SDLK_END:
-        return KeyCode::END;
-    case SDLK_HOME:
-        return KeyCode::HOME;
-    case SDLK_LEFT:
-        return KeyCode::LEFT;
-    case SDLK_UP:
-        return KeyCode::UP;
-    case SDLK_RIGHT:
-        return KeyCode::RIGHT;
-    case SDLK_DOWN:
-        return KeyCode::DOWN;
-    case SDLK_INSERT:
-        return KeyCode::INSERT;
-    case SDLK_DELETE:
-        return KeyCode::DELETE;
-    case SDLK_NUMLOCKCLEAR:
-        return KeyCode::NUM_LOCK;
-    case SDLK_SCROLLLOCK:
-        return KeyCode::SCROLL_LOCK;
-    case SDLK_SEMICOLON:
-        return KeyCode::SEMICOLON;
-    case SDLK_EQUALS:
-        return KeyCode::EQUAL;
-    case SDLK_COMMA:
-        return KeyCode::COMMA;
-    case SDLK_MINUS:
-        return KeyCode::MINUS;
-    case SDLK_PERIOD:
-        return KeyCode::PERIOD;
-    case SDLK_SLASH:
-        return KeyCode::SLASH;
-    case SDLK_GRAVE:
-        return KeyCode::GRAVE;
-    case SDLK_LEFTBRACKET:
-        return KeyCode::LEFT_BRACKET;
-    case SDLK_BACKSLASH:
-        return KeyCode::BACKSLASH;
-    case SDLK_RIGHTBRACKET:
-        return KeyCode::RIGHT_BRACKET;
-    case SDLK_APOSTROPHE:
-        return KeyCode::APOSTROPHE;
-    case SDLK_LGUI:
-        return KeyCode::LEFT_SUPER;
-    case SDLK_RGUI:
-        return KeyCode::RIGHT_SUPER;
-    case SDLK_LALT:
-        return KeyCode::LEFT_ALT;
-    case SDLK_RALT:
-        return KeyCode::RIGHT_ALT;
-    case SDLK_KP_ENTER:
-        return KeyCode::ENTER;
-    case SDLK_KP_MINUS:
-        return KeyCode::NUMPAD_SUBTRACT;
-    case SDLK_KP_MULTIPLY:
-        return KeyCode::NUMPAD_MULTIPLY;
-    case SDLK_KP_PLUS:
-        return KeyCode::NUMPAD_ADD;
-    case SDLK_KP_DIVIDE:
-        return KeyCode::NUMPAD_DIVIDE;
-    case SDLK_KP_DECIMAL:
-        return KeyCode::NUMPAD_DECIMAL;
-    case SDLK_KP_0:
-        return KeyCode::NUMPAD_0;
-    }
-    if(keyCode < 256)
-        return (KeyCode)keyCode;
-    return KeyCode::UNKNOWN;
+    if(keyCode & SDLK_SCANCODE_MASK)
+        return sdlScancodeKeys[keyCode & ~SDLK_SCANCODE_MASK];
+    return sdlKeycodeKeys[keyCode];
 }
 
 uint32_t SDL3GameWindow::getKeyFromKeyCode(KeyCode code, int metaState) {
-    SDL_Scancode scancode = SDL_SCANCODE_UNKNOWN;
-    if(code >= KeyCode::NUM_1 && code <= KeyCode::NUM_9)
-        scancode = (SDL_Scancode)((int)code - (int)KeyCode::NUM_1 + SDL_SCANCODE_1);
-    else if(code >= KeyCode::NUMPAD_1 && code <= KeyCode::NUMPAD_9)
-        scancode = (SDL_Scancode)((int)code - (int)KeyCode::NUMPAD_1 + SDL_SCANCODE_KP_1);
-    else if(code >= KeyCode::A && code <= KeyCode::Z)
-        scancode = (SDL_Scancode)((int)code - (int)KeyCode::A + SDL_SCANCODE_A);
-    else if(code >= KeyCode::FN1 && code <= KeyCode::FN12)
-        scancode = (SDL_Scancode)((int)code - (int)KeyCode::FN1 + SDL_SCANCODE_F1);
-    else {
-        switch(code) {
-        case KeyCode::BACK:
-            scancode = SDL_SCANCODE_AC_BACK;
-            break;
-        case KeyCode::BACKSPACE:
-            scancode = SDL_SCANCODE_BACKSPACE;
-            break;
-        case KeyCode::TAB:
-            scancode = SDL_SCANCODE_TAB;
-            break;
-        case KeyCode::ENTER:
-            scancode = SDL_SCANCODE_RETURN;
-            break;
-        case KeyCode::LEFT_SHIFT:
-            scancode = SDL_SCANCODE_LSHIFT;
-            break;
-        case KeyCode::RIGHT_SHIFT:
-            scancode = SDL_SCANCODE_RSHIFT;
-            break;
-        case KeyCode::LEFT_CTRL:
-            scancode = SDL_SCANCODE_LCTRL;
-            break;
-        case KeyCode::RIGHT_CTRL:
-            scancode = SDL_SCANCODE_RCTRL;
-            break;
-        case KeyCode::PAUSE:
-            scancode = SDL_SCANCODE_PAUSE;
-            break;
-        case KeyCode::CAPS_LOCK:
-            scancode = SDL_SCANCODE_CAPSLOCK;
-            break;
-        case KeyCode::ESCAPE:
-            scancode = SDL_SCANCODE_ESCAPE;
-            break;
-        case KeyCode::SPACE:
-            scancode = SDL_SCANCODE_SPACE;
-            break;
-        case KeyCode::PAGE_UP:
-            scancode = SDL_SCANCODE_PAGEUP;
-            break;
-        case KeyCode::PAGE_DOWN:
-            scancode = SDL_SCANCODE_PAGEDOWN;
-            break;
-        case KeyCode::END:
-            scancode = SDL_SCANCODE_END;
-            break;
-        case KeyCode::HOME:
-            scancode = SDL_SCANCODE_HOME;
-            break;
-        case KeyCode::LEFT:
-            scancode = SDL_SCANCODE_LEFT;
-            break;
-        case KeyCode::UP:
-            scancode = SDL_SCANCODE_UP;
-            break;
-        case KeyCode::RIGHT:
-            scancode = SDL_SCANCODE_RIGHT;
-            break;
-        case KeyCode::DOWN:
-            scancode = SDL_SCANCODE_DOWN;
-            break;
-        case KeyCode::INSERT:
-            scancode = SDL_SCANCODE_INSERT;
-            break;
-        case KeyCode::DELETE:
-            scancode = SDL_SCANCODE_DELETE;
-            break;
-        case KeyCode::NUM_LOCK:
-            scancode = SDL_SCANCODE_NUMLOCKCLEAR;
-            break;
-        case KeyCode::SCROLL_LOCK:
-            scancode = SDL_SCANCODE_SCROLLLOCK;
-            break;
-        case KeyCode::SEMICOLON:
-            scancode = SDL_SCANCODE_SEMICOLON;
-            break;
-        case KeyCode::EQUAL:
-            scancode = SDL_SCANCODE_EQUALS;
-            break;
-        case KeyCode::COMMA:
-            scancode = SDL_SCANCODE_COMMA;
-            break;
-        case KeyCode::MINUS:
-            scancode = SDL_SCANCODE_MINUS;
-            break;
-        case KeyCode::NUMPAD_ADD:
-            scancode = SDL_SCANCODE_KP_PLUS;
-            break;
-        case KeyCode::NUMPAD_SUBTRACT:
-            scancode = SDL_SCANCODE_KP_MINUS;
-            break;
-        case KeyCode::NUMPAD_MULTIPLY:
-            scancode = SDL_SCANCODE_KP_MULTIPLY;
-            break;
-        case KeyCode::NUMPAD_DIVIDE:
-            scancode = SDL_SCANCODE_KP_DIVIDE;
-            break;
-        case KeyCode::PERIOD:
-            scancode = SDL_SCANCODE_KP_PERIOD;
-            break;
-        case KeyCode::NUMPAD_DECIMAL:
-            scancode = SDL_SCANCODE_KP_DECIMAL;
-            break;
-        case KeyCode::SLASH:
-            scancode = SDL_SCANCODE_SLASH;
-            break;
-        case KeyCode::GRAVE:
-            scancode = SDL_SCANCODE_GRAVE;
-            break;
-        case KeyCode::LEFT_BRACKET:
-            scancode = SDL_SCANCODE_LEFTBRACKET;
-            break;
-        case KeyCode::BACKSLASH:
-            scancode = SDL_SCANCODE_BACKSLASH;
-            break;
-        case KeyCode::RIGHT_BRACKET:
-            scancode = SDL_SCANCODE_RIGHTBRACKET;
-            break;
-        case KeyCode::APOSTROPHE:
-            scancode = SDL_SCANCODE_APOSTROPHE;
-            break;
-        case KeyCode::MENU:
-            scancode = SDL_SCANCODE_MENU;
-            break;
-        case KeyCode::LEFT_SUPER:
-            scancode = SDL_SCANCODE_LGUI;
-            break;
-        case KeyCode::RIGHT_SUPER:
-            scancode = SDL_SCANCODE_RGUI;
-            break;
-        case KeyCode::LEFT_ALT:
-            scancode = SDL_SCANCODE_LALT;
-            break;
-        case KeyCode::RIGHT_ALT:
-            scancode = SDL_SCANCODE_RALT;
-            break;
-        case KeyCode::NUM_0:
-            scancode = SDL_SCANCODE_0;
-            break;
-        case KeyCode::NUMPAD_0:
-            scancode = SDL_SCANCODE_KP_0;
-            break;
-        default:
-            return 0;
-        }
-    }
+    SDL_Scancode scancode = (SDL_Scancode)sdlScancodes[code];
+    if(scancode == SDL_SCANCODE_UNKNOWN)
+        return 0;
     SDL_Keymod modstate = SDL_KMOD_NONE;
     if(metaState & KEY_MOD_SHIFT) {
         modstate |= SDL_KMOD_SHIFT;
@@ -5,7 +5,31 @@
 
 #include <game_window.h>
 #include <mutex>
+#include <vector>
+#include <string>
 #include <SDL3/SDL.h>
+#include "x11_clipboard_reader.h"
+
+class SDL3SharedContext : public GameWindowSharedContext {
+private:
+    // Hidden window, binding the surface of the game window on two threads at once isn't allowed with EGL
+    SDL_Window* window;
+    SDL_GLContext context;
+
+    // Windows and contexts of released shared contexts, SDL only allows destroying them on the main thread
+    static std::mutex retiredLock;
+    static std::vector<std::pair<SDL_Window*, SDL_GLContext>> retired;
+
+public:
+    SDL3SharedContext(SDL_Window* window, SDL_GLContext context) : window(window), context(context) {}
+
+    ~SDL3SharedContext() override;
+
+    void makeCurrent(bool active) override;
+
+    // Destroys the windows and contexts released since the last call, on the main thread
+    static void destroyRetired();
+};
 
 class SDL3GameWindow : public GameWindow {
 private:
@@ -29,12 +53,40 @@ private:
     RequestWindowMode requestedWindowMode = RequestWindowMode::None;
     bool pendingFullscreenModeSwitch = false;
     FullscreenMode mode;
-    std::vector<FullscreenMode> modes;
+    // Joystick instance id per reported gamepad id, 0 if unused
+    SDL_JoystickID gamepadSlots[MAX_GAMEPADS] = {};
 
     bool isMouseInWindow();
+    int getGamepadSlot(SDL_JoystickID instanceId, bool assign);
     static KeyCode getKeyMinecraft(int keyCode);
     static int translateMeta(SDL_Keymod meta);
 
+    class SDL3WindowManager* manager;
+    // Filled by SDL3WindowManager::pumpEvents, SDL frees the text of events on the next poll so it is copied to pendingText
+    struct QueuedEvent {
+        SDL_Event event;
+        // UINT32_MAX if the event has no text
+        uint32_t textOffset;
+    };
+    std::vector<QueuedEvent> pendingEvents, dispatchedEvents;
+    std::string pendingText, dispatchedText;
+    // Bounds the queue of a window which doesn't poll, see SDL3WindowManager::pumpEvents
+    static constexpr size_t MAX_PENDING_EVENTS = 4096;
+
+    // Reads pastes without blocking the poll on X11, wakes up a waiting poll once done
+    X11ClipboardReader clipboardReader{[] {
+        SDL_Event ev = {};
+        ev.type = SDL_EVENT_USER;
+        SDL_PushEvent(&ev);
+    }};
+    bool asyncClipboard = false;
+
+    friend class SDL3WindowManager;
+
+    void queueNativeEvent(SDL_Event const& ev);
+
+    void pumpEvents(double timeout);
+
 public:
     SDL3GameWindow(const std::string& title, int width, int height, GraphicsApi api);
 
@@ -52,8 +104,12 @@ public:
 
     void close() override;
 
+    using GameWindow::pollEvents;
+
     void pollEvents() override;
 
+    void waitEvents(double timeout) override;
+
     bool getCursorDisabled() override;
 
     void setCursorDisabled(bool disabled) override;
@@ -70,6 +126,12 @@ public:
 
     void setSwapInterval(int interval) override;
 
+    int getSwapInterval() override;
+
+    double getDisplayRefreshRate() override;
+
+    std::shared_ptr<GameWindowSharedContext> createSharedContext() override;
+
     void startTextInput() override;
 
     void stopTextInput() override;
@@ -78,7 +140,7 @@ public:
 
     FullscreenMode getFullscreenMode() override;
 
-    std::vector<FullscreenMode> getFullscreenModes() override;
+    std::vector<FullscreenMode> const& getFullscreenModes() override;
 
     uint32_t getKeyFromKeyCode(KeyCode code, int metaState) override;
 };
@@ -0,0 +1,226 @@
+#include "x11_clipboard_reader.h"
+
+#if !defined(__APPLE__) && __has_include(<X11/Xlib.h>)
+#define GAMEWINDOW_X11_CLIPBOARD
+#endif
+
+#ifdef GAMEWINDOW_X11_CLIPBOARD
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <chrono>
+#include <climits>
+#include <dlfcn.h>
+#include <poll.h>
+#include <type_traits>
+
+// libX11 is loaded at runtime, the backends don't link it and may not run on X11 at all
+static struct {
+    bool loaded = false;
+    decltype(&::XOpenDisplay) XOpenDisplay;
+    decltype(&::XCloseDisplay) XCloseDisplay;
+    decltype(&::XDefaultRootWindow) XDefaultRootWindow;
+    decltype(&::XCreateSimpleWindow) XCreateSimpleWindow;
+    decltype(&::XDestroyWindow) XDestroyWindow;
+    decltype(&::XSelectInput) XSelectInput;
+    decltype(&::XInternAtom) XInternAtom;
+    decltype(&::XConvertSelection) XConvertSelection;
+    decltype(&::XFlush) XFlush;
+    decltype(&::XPending) XPending;
+    decltype(&::XNextEvent) XNextEvent;
+    decltype(&::XGetWindowProperty) XGetWindowProperty;
+    decltype(&::XFree) XFree;
+    decltype(&::XConnectionNumber) XConnectionNumber;
+} x11;
+
+static bool loadX11() {
+    if (x11.loaded)
+        return true;
+    void* lib = dlopen("libX11.so.6", RTLD_LAZY | RTLD_LOCAL);
+    if (lib == nullptr)
+        return false;
+    bool ok = true;
+    auto load = [&](auto& func, const char* name) {
+        func = (std::remove_reference_t<decltype(func)>)dlsym(lib, name);
+        ok = ok && func != nullptr;
+    };
+    load(x11.XOpenDisplay, "XOpenDisplay");
+    load(x11.XCloseDisplay, "XCloseDisplay");
+    load(x11.XDefaultRootWindow, "XDefaultRootWindow");
+    load(x11.XCreateSimpleWindow, "XCreateSimpleWindow");
+    load(x11.XDestroyWindow, "XDestroyWindow");
+    load(x11.XSelectInput, "XSelectInput");
+    load(x11.XInternAtom, "XInternAtom");
+    load(x11.XConvertSelection, "XConvertSelection");
+    load(x11.XFlush, "XFlush");
+    load(x11.XPending, "XPending");
+    load(x11.XNextEvent, "XNextEvent");
+    load(x11.XGetWindowProperty, "XGetWindowProperty");
+    load(x11.XFree, "XFree");
+    load(x11.XConnectionNumber, "XConnectionNumber");
+    if (!ok) {
+        dlclose(lib);
+        return false;
+    }
+    x11.loaded = true;
+    return true;
+}
+
+struct X11ClipboardReader::Connection {
+    Display* display;
+    Window window;
+    Atom clipboard, utf8String, property, incr;
+};
+
+// Owners not answering within this time are given up on
+static const auto SELECTION_TIMEOUT = std::chrono::seconds(5);
+
+X11ClipboardReader::~X11ClipboardReader() {
+    if (thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        cv.notify_one();
+        thread.join();
+    }
+    if (connection != nullptr) {
+        x11.XDestroyWindow(connection->display, connection->window);
+        x11.XCloseDisplay(connection->display);
+        delete connection;
+    }
+}
+
+bool X11ClipboardReader::request() {
+    if (unavailable)
+        return false;
+    if (connection == nullptr) {
+        Display* display = loadX11() ? x11.XOpenDisplay(nullptr) : nullptr;
+        if (display == nullptr) {
+            unavailable = true;
+            return false;
+        }
+        // Only used by the worker from here on
+        connection = new Connection();
+        connection->display = display;
+        connection->window = x11.XCreateSimpleWindow(display, x11.XDefaultRootWindow(display), 0, 0, 1, 1, 0, 0, 0);
+        // INCR transfers continue with PropertyNotify events
+        x11.XSelectInput(display, connection->window, PropertyChangeMask);
+        connection->clipboard = x11.XInternAtom(display, "CLIPBOARD", False);
+        connection->utf8String = x11.XInternAtom(display, "UTF8_STRING", False);
+        connection->property = x11.XInternAtom(display, "GAMEWINDOW_PASTE", False);
+        connection->incr = x11.XInternAtom(display, "INCR", False);
+        thread = std::thread(&X11ClipboardReader::run, this);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requested = true;
+    }
+    cv.notify_one();
+    return true;
+}
+
+bool X11ClipboardReader::take(std::string& text) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!ready)
+        return false;
+    ready = false;
+    text = std::move(this->text);
+    this->text.clear();
+    return true;
+}
+
+void X11ClipboardReader::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [this] { return requested || stop; });
+        if (stop)
+            break;
+        // Requests made while reading are answered by this read
+        requested = false;
+        lock.unlock();
+        std::string result;
+        bool ok = readSelection(result);
+        lock.lock();
+        if (ok) {
+            text = std::move(result);
+            ready = true;
+            if (wake)
+                wake();
+        }
+    }
+}
+
+bool X11ClipboardReader::readSelection(std::string& out) {
+    Display* display = connection->display;
+    x11.XConvertSelection(display, connection->clipboard, connection->utf8String, connection->property, connection->window, CurrentTime);
+    x11.XFlush(display);
+    auto deadline = std::chrono::steady_clock::now() + SELECTION_TIMEOUT;
+    // Appends the property to out and deletes it, which asks the owner for the next step of an INCR transfer
+    auto readProperty = [&](Atom& type) {
+        int format;
+        unsigned long count, remaining;
+        unsigned char* data = nullptr;
+        if (x11.XGetWindowProperty(display, connection->window, connection->property, 0, LONG_MAX / 4, True, AnyPropertyType, &type, &format, &count, &remaining, &data) != Success)
+            return (size_t)0;
+        size_t bytes = count * (format / 8);
+        if (data != nullptr) {
+            if (type != connection->incr)
+                out.append((const char*)data, bytes);
+            x11.XFree(data);
+        }
+        return bytes;
+    };
+    bool incr = false;
+    while (!stop) {
+        if (x11.XPending(display) == 0) {
+            if (std::chrono::steady_clock::now() >= deadline)
+                return false;
+            // Short timeout, so stop is noticed while the owner doesn't answer
+            pollfd fd = {x11.XConnectionNumber(display), POLLIN, 0};
+            poll(&fd, 1, 100);
+            continue;
+        }
+        XEvent ev;
+        x11.XNextEvent(display, &ev);
+        if (!incr && ev.type == SelectionNotify) {
+            // No owner or the owner can't convert to UTF-8
+            if (ev.xselection.property == None)
+                return false;
+            Atom type;
+            readProperty(type);
+            if (type != connection->incr)
+                return true;
+            incr = true;
+            x11.XFlush(display);
+        } else if (incr && ev.type == PropertyNotify && ev.xproperty.atom == connection->property && ev.xproperty.state == PropertyNewValue) {
+            Atom type;
+            // The transfer ends with an empty step
+            if (readProperty(type) == 0)
+                return true;
+            x11.XFlush(display);
+            deadline = std::chrono::steady_clock::now() + SELECTION_TIMEOUT;
+        }
+    }
+    return false;
+}
+#else
+struct X11ClipboardReader::Connection {};
+
+X11ClipboardReader::~X11ClipboardReader() {
+}
+
+bool X11ClipboardReader::request() {
+    return false;
+}
+
+bool X11ClipboardReader::take(std::string& text) {
+    return false;
+}
+
+void X11ClipboardReader::run() {
+}
+
+bool X11ClipboardReader::readSelection(std::string& out) {
+    return false;
+}
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Reads the X11 CLIPBOARD selection on a worker thread with a display connection of its own,
+// the selection owner may take long to answer or send a large selection in INCR steps
+// For backends running on X11, the backends' own clipboard functions block their event loop until the owner answered
+class X11ClipboardReader {
+private:
+    struct Connection;
+
+    std::function<void()> wake;
+    Connection* connection = nullptr;
+    bool unavailable = false;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool requested = false, ready = false;
+    std::atomic<bool> stop{false};
+    std::string text;
+
+    void run();
+    bool readSelection(std::string& out);
+
+public:
+    // wake is called on the worker once a paste is ready, e.g. to interrupt a waiting poll
+    explicit X11ClipboardReader(std::function<void()> wake) : wake(std::move(wake)) {}
+
+    ~X11ClipboardReader();
+
+    X11ClipboardReader(X11ClipboardReader const&) = delete;
+
+    X11ClipboardReader& operator=(X11ClipboardReader const&) = delete;
+
+    // Starts a read unless one is running, false if there is no X11 display and the caller has to read the clipboard itself
+    bool request();
+
+    // True once per finished read, with the text of the selection
+    bool take(std::string& text);
+};
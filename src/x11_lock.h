@@ -0,0 +1,45 @@
+#pragma once
+
+#include <game_window.h>
+#include "game_window_metrics_collector.h"
+#include <atomic>
+#include <mutex>
+
+// Recursive mutex recording how long callers had to wait for it
+// Windows hold one for event pumping and one for presenting, always lock the event lock first when both are needed
+class X11Lock {
+private:
+    std::recursive_mutex mutex;
+    std::atomic<uint64_t> acquisitions{0};
+    std::atomic<uint64_t> contendedAcquisitions{0};
+    std::atomic<uint64_t> totalWaitTime{0};
+    std::atomic<uint64_t> maxWaitTime{0};
+
+public:
+    void lock() {
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+        if(mutex.try_lock())
+            return;
+        uint64_t start = GameWindow::getTimestamp();
+        mutex.lock();
+        uint64_t wait = GameWindow::getTimestamp() - start;
+        contendedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+        totalWaitTime.fetch_add(wait, std::memory_order_relaxed);
+        uint64_t max = maxWaitTime.load(std::memory_order_relaxed);
+        while(wait > max && !maxWaitTime.compare_exchange_weak(max, wait, std::memory_order_relaxed));
+        GameWindowMetricsCollector::record(GameWindowMetricsCollector::HistogramId::X11_LOCK_WAIT, wait);
+    }
+
+    void unlock() {
+        mutex.unlock();
+    }
+
+    GameWindow::LockWaitStats getStats() const {
+        GameWindow::LockWaitStats stats;
+        stats.acquisitions = acquisitions.load(std::memory_order_relaxed);
+        stats.contendedAcquisitions = contendedAcquisitions.load(std::memory_order_relaxed);
+        stats.totalWaitTime = totalWaitTime.load(std::memory_order_relaxed);
+        stats.maxWaitTime = maxWaitTime.load(std::memory_order_relaxed);
+        return stats;
+    }
+};